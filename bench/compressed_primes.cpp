@@ -0,0 +1,83 @@
+///
+/// @file   compressed_primes.cpp
+/// @brief  Compare the memory usage and the scan speed of
+///         primesieve::compressed_primes with std::vector<uint64_t>.
+///         The primes are summed up sequentially (best of 5).
+///
+///         Usage: bench_compressed_primes [stop]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+template <typename T>
+double scan(const T& primes, uint64_t& sum)
+{
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    double t1 = now();
+    sum = 0;
+    for (uint64_t prime : primes)
+      sum += prime;
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t stop = (uint64_t) 2e9;
+  if (argc > 1)
+    stop = std::strtoull(argv[1], nullptr, 10);
+
+  std::vector<uint64_t> primes1;
+  primesieve::compressed_primes primes2;
+
+  double t1 = now();
+  primesieve::generate_primes(stop, &primes1);
+  double t2 = now();
+  primesieve::generate_primes(stop, &primes2);
+  double t3 = now();
+
+  uint64_t sum1 = 0;
+  uint64_t sum2 = 0;
+  double seconds1 = scan(primes1, sum1);
+  double seconds2 = scan(primes2, sum2);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Primes: " << primes1.size() << std::endl;
+  std::cout << "std::vector<uint64_t>: " << primes1.size() * 8 / (1 << 20) << " MiB, "
+            << "generate: " << t2 - t1 << " sec, scan: " << seconds1 << " sec" << std::endl;
+  std::cout << "compressed_primes:     " << primes2.bytes() / (1 << 20) << " MiB, "
+            << "generate: " << t3 - t2 << " sec, scan: " << seconds2 << " sec" << std::endl;
+  std::cout << "Compression ratio: " << (double) (primes1.size() * 8) / primes2.bytes() << std::endl;
+  std::cout << "Sums: " << ((sum1 == sum2) ? "equal" : "NOT equal!") << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+///
+/// @file   eratbig.cpp
+/// @brief  A/B benchmark of EratBig::crossOff(): the portable
+///         scalar code path versus the AVX512 code path which
+///         uses gather/scatter instructions and conflict
+///         detection. Both code paths must produce the same
+///         sieve arrays. If the CPU does not support AVX512 CD
+///         both runs use the scalar code path.
+///
+///         Usage: bench_eratbig [start] [segments]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/EratBig.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Seconds needed to cross off the multiples
+/// of the EratBig sieving primes.
+///
+double crossOffTime(bool avx512,
+                    uint64_t start,
+                    uint64_t segments,
+                    std::vector<uint8_t>& sieve)
+{
+  uint64_t sieveSize = config::SIEVE_BYTES;
+  uint64_t stop = start + sieveSize * 30 * segments;
+  uint64_t sqrtStop = isqrt(stop);
+  // Like Erat, EratBig only sieves primes > maxEratMedium
+  uint64_t maxEratMedium = (uint64_t) (sieveSize * config::FACTOR_ERATMEDIUM);
+
+  MemoryPool memoryPool;
+  EratBig eratBig;
+  eratBig.init(stop, sieveSize, sqrtStop, &memoryPool);
+  eratBig.setAvx512(avx512);
+
+  primesieve::iterator it(maxEratMedium);
+  uint64_t prime = it.next_prime();
+  uint64_t segmentLow = start;
+
+  sieve.resize(sieveSize);
+  std::fill(sieve.begin(), sieve.end(), (uint8_t) 0xff);
+  double seconds = 0;
+
+  for (uint64_t i = 0; i < segments; i++)
+  {
+    // Like Erat, we only add the sieving primes
+    // whose square is <= the current segment high.
+    uint64_t segmentHigh = segmentLow + sieveSize * 30 + 6;
+    for (; prime * prime <= segmentHigh; prime = it.next_prime())
+      eratBig.addSievingPrime(prime, segmentLow);
+
+    segmentLow += sieveSize * 30;
+    double t1 = now();
+    eratBig.crossOff(sieve.data());
+    double t2 = now();
+    seconds += t2 - t1;
+  }
+
+  return seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t start = (uint64_t) 1e16;
+  uint64_t segments = 1000;
+
+  if (argc > 1)
+    start = (uint64_t) std::atof(argv[1]);
+  if (argc > 2)
+    segments = std::atol(argv[2]);
+
+  // The sieve array's segmentLow must be a multiple of 30
+  start -= start % 30;
+
+  std::vector<uint8_t> sieve1;
+  std::vector<uint8_t> sieve2;
+
+  double scalar = crossOffTime(false, start, segments, sieve1);
+  double avx512 = crossOffTime(true, start, segments, sieve2);
+
+  if (sieve1 != sieve2)
+  {
+    std::cerr << "ERROR: scalar and AVX512 sieve arrays differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Start: " << start << std::endl;
+  std::cout << "Segments: " << segments << std::endl;
+  std::cout << "Scalar: " << scalar << " sec" << std::endl;
+  std::cout << "AVX512: " << avx512 << " sec" << std::endl;
+  std::cout << "Speedup: " << scalar / avx512 << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+///
+/// @file   eratmedium.cpp
+/// @brief  Benchmark EratMedium::crossOff() processing the sieve
+///         array in tiles versus processing the entire sieve
+///         array at once. Tiling only pays off if the sieve
+///         array does not fit into the L2 cache. Both must
+///         produce the same sieve arrays.
+///
+///         Usage: bench_eratmedium [sieve size in KiB] [segments] [tile size in KiB]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/EratMedium.hpp>
+#include <primesieve/MemoryPool.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Seconds needed to cross off the multiples
+/// of the EratMedium sieving primes.
+///
+double crossOffTime(uint64_t tileSize,
+                    uint64_t sieveSize,
+                    uint64_t segments,
+                    std::vector<uint8_t>& sieve)
+{
+  // Start at 10^15 so that all EratMedium
+  // sieving primes are used in each segment.
+  uint64_t start = (uint64_t) 1e15;
+  start -= start % 30;
+  uint64_t stop = start + sieveSize * 30 * segments;
+  uint64_t l1CacheSize = cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() : config::L1D_CACHE_BYTES;
+  uint64_t maxEratSmall = (uint64_t) (l1CacheSize * config::FACTOR_ERATSMALL);
+  uint64_t maxEratMedium = (uint64_t) (sieveSize * config::FACTOR_ERATMEDIUM);
+
+  MemoryPool memoryPool;
+  EratMedium eratMedium;
+  eratMedium.init(stop, sieveSize, tileSize, maxEratMedium, &memoryPool);
+  primesieve::iterator it(maxEratSmall);
+
+  for (uint64_t prime = it.next_prime(); prime <= maxEratMedium; prime = it.next_prime())
+    eratMedium.addSievingPrime(prime, start);
+
+  sieve.resize(sieveSize);
+  std::fill(sieve.begin(), sieve.end(), (uint8_t) 0xff);
+  double seconds = 0;
+
+  for (uint64_t i = 0; i < segments; i++)
+  {
+    double t1 = now();
+    eratMedium.crossOff(sieve.data(), sieveSize);
+    double t2 = now();
+    seconds += t2 - t1;
+  }
+
+  return seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t sieveSize = get_sieve_size() << 10;
+  uint64_t segments = 200;
+
+  if (argc > 1)
+    sieveSize = std::atol(argv[1]) << 10;
+  if (argc > 2)
+    segments = std::atol(argv[2]);
+
+  // Default tile size used by Erat
+  uint64_t l1CacheSize = cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() : config::L1D_CACHE_BYTES;
+  uint64_t tileSize = l1CacheSize * 8;
+
+  if (argc > 3)
+    tileSize = std::atol(argv[3]) << 10;
+
+  std::vector<uint8_t> sieve1;
+  std::vector<uint8_t> sieve2;
+
+  double untiled = crossOffTime(sieveSize, sieveSize, segments, sieve1);
+  double tiled = crossOffTime(tileSize, sieveSize, segments, sieve2);
+
+  if (sieve1 != sieve2)
+  {
+    std::cerr << "ERROR: tiled and untiled sieve arrays differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Sieve size: " << (sieveSize >> 10) << " KiB" << std::endl;
+  std::cout << "Tile size: " << (tileSize >> 10) << " KiB" << std::endl;
+  std::cout << "Untiled: " << untiled << " sec" << std::endl;
+  std::cout << "Tiled: " << tiled << " sec" << std::endl;
+  std::cout << "Speedup: " << untiled / tiled << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+///
+/// @file   eratsmall.cpp
+/// @brief  Find the largest sieving prime for which crossing
+///         off multiples using precomputed bit patterns
+///         (EratSmall::crossOffPatterns()) is faster than
+///         crossing off multiples one byte at a time. The
+///         result is used to tune config::MAX_PATTERN_PRIME.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/EratSmall.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Seconds per segment for crossing off the multiples
+/// of the primes inside [low, high[ using EratSmall.
+///
+double segmentTime(uint64_t low,
+                   uint64_t high,
+                   uint64_t maxPatternPrime,
+                   uint64_t start,
+                   uint64_t sieveSize,
+                   uint64_t segments,
+                   std::vector<uint8_t>& sieve)
+{
+  uint64_t stop = start + sieveSize * 30 * segments;
+  uint64_t l1CacheSize = cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() : (32 << 10);
+  l1CacheSize = std::min(l1CacheSize, sieveSize);
+
+  EratSmall eratSmall;
+  eratSmall.init(stop, l1CacheSize, high, maxPatternPrime);
+  primesieve::iterator it(low);
+
+  for (uint64_t prime = it.next_prime(); prime < high; prime = it.next_prime())
+    eratSmall.addSievingPrime(prime, start);
+
+  sieve.resize(sieveSize);
+  double best = 1e9;
+
+  for (uint64_t i = 0; i < segments; i++)
+  {
+    std::fill(sieve.begin(), sieve.end(), (uint8_t) 0xff);
+    double t1 = now();
+    eratSmall.crossOff(sieve.data(), sieveSize);
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // The sieve array's segmentLow must be a multiple of 30
+  uint64_t start = (uint64_t) 1e12;
+  start -= start % 30;
+  uint64_t segments = 200;
+  uint64_t sieveSize = get_sieve_size() << 10;
+
+  if (argc > 1)
+    sieveSize = std::atol(argv[1]) << 10;
+
+  std::vector<uint8_t> sieve1;
+  std::vector<uint8_t> sieve2;
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Sieve size: " << (sieveSize >> 10) << " KiB" << std::endl;
+  std::cout << "Primes       Bytes (us)  Patterns (us)" << std::endl;
+
+  // Primes <= 167 are removed by PreSieve
+  for (uint64_t low = 167; low < 700; low += 32)
+  {
+    uint64_t high = low + 32;
+    double t1 = segmentTime(low, high, 0, start, sieveSize, segments, sieve1);
+    double t2 = segmentTime(low, high, high, start, sieveSize, segments, sieve2);
+
+    if (sieve1 != sieve2)
+    {
+      std::cerr << "ERROR: sieve arrays differ for primes inside ["
+                << low << ", " << high << "[" << std::endl;
+      return 1;
+    }
+
+    std::cout << "[" << std::setw(4) << low << ", " << std::setw(4) << high << "[  "
+              << std::setw(10) << t1 * 1e6 << "  "
+              << std::setw(13) << t2 * 1e6 << std::endl;
+  }
+
+  return 0;
+}
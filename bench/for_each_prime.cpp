@@ -0,0 +1,97 @@
+///
+/// @file   for_each_prime.cpp
+/// @brief  Compare the throughput of a reduction (sum of the
+///         primes) using for_each_prime(), iterator::next_prime()
+///         and generate_primes() + loop over the vector.
+///         Single-threaded, best of 5 runs.
+///
+///         Usage: bench_for_each_prime [distance]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+template <typename F>
+double best_of_5(F f)
+{
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    double t1 = now();
+    f();
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t dist = (uint64_t) 1e9;
+  if (argc > 1)
+    dist = std::strtoull(argv[1], nullptr, 10);
+
+  primesieve::set_num_threads(1);
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (uint64_t start : { (uint64_t) 0, (uint64_t) 1e10, (uint64_t) 1e13, (uint64_t) 1e16 })
+  {
+    uint64_t stop = start + dist;
+    uint64_t sum1 = 0, sum2 = 0, sum3 = 0;
+
+    double seconds1 = best_of_5([&]()
+    {
+      sum1 = 0;
+      primesieve::for_each_prime(start, stop, [&](uint64_t prime) { sum1 += prime; });
+    });
+
+    double seconds2 = best_of_5([&]()
+    {
+      sum2 = 0;
+      primesieve::iterator it(start, stop);
+      for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+        sum2 += prime;
+    });
+
+    double seconds3 = best_of_5([&]()
+    {
+      sum3 = 0;
+      std::vector<uint64_t> primes;
+      primesieve::generate_primes(start, stop, &primes);
+      for (uint64_t prime : primes)
+        sum3 += prime;
+    });
+
+    std::cout << "[" << start << ", " << start << " + " << dist << "]" << std::endl;
+    std::cout << "  for_each_prime():  " << seconds1 << " sec" << std::endl;
+    std::cout << "  next_prime():      " << seconds2 << " sec" << std::endl;
+    std::cout << "  generate_primes(): " << seconds3 << " sec" << std::endl;
+    std::cout << "  Sums: " << ((sum1 == sum2 && sum1 == sum3) ? "equal" : "NOT equal!") << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+///
+/// @file   next_prime.cpp
+/// @brief  Benchmark primesieve::iterator::next_prime() throughput
+///         at different start numbers. fillPrimes() dispatches
+///         at runtime to the AVX512 VBMI2, AVX2 or default (CTZ)
+///         algorithm for decoding the sieve array into primes.
+///
+///         Usage: bench_next_prime [distance]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/cpuid.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace primesieve;
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Best of 5 runs, returns millions of primes per second
+double benchmark(uint64_t start, uint64_t dist, uint64_t& sum)
+{
+  uint64_t stop = start + dist;
+  uint64_t count = 0;
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    sum = 0;
+    count = 0;
+    double t1 = now();
+    primesieve::iterator it(start, stop);
+    for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+    {
+      sum += prime;
+      count++;
+    }
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return count / best / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t dist = (uint64_t) 3e8;
+  if (argc > 1)
+    dist = std::strtoull(argv[1], nullptr, 10);
+
+#if defined(PRIMESIEVE_X86_CPUID)
+  std::cout << "CPU supports AVX2: " << (has_cpuid_avx2() ? "yes" : "no") << std::endl;
+  std::cout << "CPU supports AVX512 VBMI2: " << (has_cpuid_avx512_vbmi2() ? "yes" : "no") << std::endl;
+#endif
+  std::cout << std::fixed << std::setprecision(1);
+
+  for (uint64_t start : { (uint64_t) 0, (uint64_t) 1e10, (uint64_t) 1e13, (uint64_t) 1e16 })
+  {
+    uint64_t sum = 0;
+    double speed = benchmark(start, dist, sum);
+    std::cout << "next_prime() [" << start << ", " << start + dist << "]: "
+              << speed << " M primes/s (sum: " << sum << ")" << std::endl;
+  }
+
+  return 0;
+}
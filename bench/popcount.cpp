@@ -0,0 +1,102 @@
+///
+/// @file   popcount.cpp
+/// @brief  Benchmark popcount() (which dispatches at runtime to
+///         the fastest implementation supported by the CPU)
+///         against a simple POPCNT loop using arrays whose size
+///         is the sieve size.
+///
+///         Usage: bench_popcount [sieve size in KiB]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/cpuid.hpp>
+#include <primesieve/forward.hpp>
+#include <primesieve/intrinsics.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+uint64_t popcount_popcnt64(const uint64_t* array, uint64_t size)
+{
+  uint64_t cnt = 0;
+  for (uint64_t i = 0; i < size; i++)
+    cnt += popcnt64(array[i]);
+  return cnt;
+}
+
+/// Best of 5 runs, returns GiB/s
+template <typename F>
+double benchmark(F popcount, const std::vector<uint64_t>& array, uint64_t& cnt)
+{
+  uint64_t iters = std::max((uint64_t) 1, ((uint64_t) 1 << 30) / (array.size() * 8));
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    cnt = 0;
+    double t1 = now();
+    for (uint64_t j = 0; j < iters; j++)
+      cnt += popcount(array.data(), array.size());
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return iters * array.size() * 8 / best / (1 << 30);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t sieveSize = get_sieve_size();
+  if (argc > 1)
+    sieveSize = std::atol(argv[1]);
+
+  std::mt19937_64 gen(123);
+  std::vector<uint64_t> array((sieveSize << 10) / 8);
+  for (auto& x : array)
+    x = gen();
+
+  uint64_t cnt1, cnt2;
+  double speed1 = benchmark(popcount_popcnt64, array, cnt1);
+  double speed2 = benchmark(popcount, array, cnt2);
+
+  if (cnt1 != cnt2)
+  {
+    std::cerr << "ERROR: popcount() results differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Array size: " << sieveSize << " KiB" << std::endl;
+#if defined(PRIMESIEVE_X86_CPUID)
+  std::cout << "CPU supports AVX2: " << (has_cpuid_avx2() ? "yes" : "no") << std::endl;
+  std::cout << "CPU supports AVX512 VPOPCNTDQ: " << (has_cpuid_avx512_vpopcnt() ? "yes" : "no") << std::endl;
+#endif
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "popcnt64() loop: " << speed1 << " GiB/s" << std::endl;
+  std::cout << "popcount(): " << speed2 << " GiB/s" << std::endl;
+  std::cout << "Speedup: " << speed2 / speed1 << "x" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+///
+/// @file   presieve.cpp
+/// @brief  Find the break-even point of tier 2 pre-sieving
+///         (primes <= 167) versus tier 1 pre-sieving (primes
+///         < 100) followed by EratSmall crossing off the
+///         multiples of the primes inside [101, 167].
+///
+///         Tier 2 saves EratSmall::crossOff() work in each
+///         segment but it costs an additional AND pass per
+///         segment and the tier 2 buffers must be initialized
+///         once. The break-even sieving distance is:
+///         initialization time / time saved per segment.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/EratSmall.hpp>
+#include <primesieve/PreSieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+const uint64_t maxPrime = 167;
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Seconds needed to initialize the pre-sieve buffers
+double initTime(int tier)
+{
+  double best = 1e9;
+
+  for (int i = 0; i < 10; i++)
+  {
+    double t1 = now();
+    PreSieve preSieve;
+    preSieve.initBuffers(tier);
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return best;
+}
+
+/// Seconds per segment for pre-sieving using the
+/// given tier and crossing off the multiples of
+/// the remaining primes <= 167 using EratSmall.
+///
+double segmentTime(int tier,
+                   uint64_t start,
+                   uint64_t sieveSize,
+                   uint64_t segments,
+                   std::vector<uint8_t>& sieve)
+{
+  PreSieve preSieve;
+  preSieve.initBuffers(tier);
+  uint64_t stop = start + sieveSize * 30 * segments;
+  uint64_t l1CacheSize = cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() : (32 << 10);
+  l1CacheSize = std::min(l1CacheSize, sieveSize);
+
+  EratSmall eratSmall;
+  eratSmall.init(stop, l1CacheSize, maxPrime);
+  primesieve::iterator it(preSieve.getMaxPrime());
+
+  for (uint64_t prime = it.next_prime(); prime <= maxPrime; prime = it.next_prime())
+    eratSmall.addSievingPrime(prime, start);
+
+  uint64_t low = start;
+  sieve.resize(sieveSize);
+  double best = 1e9;
+
+  for (uint64_t i = 0; i < segments; i++)
+  {
+    double t1 = now();
+    preSieve.preSieve(sieve.data(), sieveSize, low);
+    if (eratSmall.hasSievingPrimes())
+      eratSmall.crossOff(sieve.data(), sieveSize);
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+    low += sieveSize * 30;
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // The sieve array's segmentLow must be a multiple of 30
+  uint64_t start = (uint64_t) 1e12;
+  start -= start % 30;
+  uint64_t segments = 2000;
+  uint64_t sieveSize = get_sieve_size() << 10;
+
+  if (argc > 1)
+    sieveSize = std::atol(argv[1]) << 10;
+
+  std::vector<uint8_t> sieve1;
+  std::vector<uint8_t> sieve2;
+
+  double init1 = initTime(1);
+  double init2 = initTime(2);
+  double seg1 = segmentTime(1, start, sieveSize, segments, sieve1);
+  double seg2 = segmentTime(2, start, sieveSize, segments, sieve2);
+
+  if (sieve1 != sieve2)
+  {
+    std::cerr << "ERROR: tier 1 and tier 2 sieve arrays differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Sieve size: " << (sieveSize >> 10) << " KiB" << std::endl;
+  std::cout << "Tier 1 init: " << init1 * 1e6 << " us" << std::endl;
+  std::cout << "Tier 2 init: " << init2 * 1e6 << " us" << std::endl;
+  std::cout << "Tier 1 + EratSmall(101..167) per segment: " << seg1 * 1e6 << " us" << std::endl;
+  std::cout << "Tier 2 per segment: " << seg2 * 1e6 << " us" << std::endl;
+
+  if (seg2 >= seg1)
+    std::cout << "Tier 2 pre-sieving does not pay off on this CPU" << std::endl;
+  else
+  {
+    double saved = seg1 - seg2;
+    double breakEvenSegments = (init2 - init1) / saved;
+    double breakEvenDist = breakEvenSegments * sieveSize * 30;
+    std::cout << std::setprecision(1);
+    std::cout << "Saved per segment: " << 100 * saved / seg1 << "%" << std::endl;
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "Break-even sieving distance: " << breakEvenDist << std::endl;
+  }
+
+  return 0;
+}
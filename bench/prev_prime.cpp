@@ -0,0 +1,109 @@
+///
+/// @file   prev_prime.cpp
+/// @brief  Benchmark primesieve::iterator::prev_prime() against
+///         next_prime() on the same intervals. Both fillPrevPrimes()
+///         and fillNextPrimes() decode the sieve array using the
+///         same AVX512 VBMI2, AVX2 or default (CTZ) algorithm,
+///         the remaining difference is the initialization overhead
+///         of prev_prime().
+///
+///         Usage: bench_prev_prime [distance]
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Best of 5 runs, returns millions of primes per second
+double nextPrime(uint64_t start, uint64_t stop, uint64_t& sum)
+{
+  uint64_t count = 0;
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    sum = 0;
+    count = 0;
+    double t1 = now();
+    primesieve::iterator it(start, stop);
+    for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+    {
+      sum += prime;
+      count++;
+    }
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return count / best / 1e6;
+}
+
+/// Best of 5 runs, returns millions of primes per second
+double prevPrime(uint64_t start, uint64_t stop, uint64_t& sum)
+{
+  uint64_t count = 0;
+  double best = 1e9;
+
+  for (int i = 0; i < 5; i++)
+  {
+    sum = 0;
+    count = 0;
+    double t1 = now();
+    primesieve::iterator it(stop, start);
+    for (uint64_t prime = it.prev_prime(); prime >= start && prime > 0; prime = it.prev_prime())
+    {
+      sum += prime;
+      count++;
+    }
+    double t2 = now();
+    best = std::min(best, t2 - t1);
+  }
+
+  return count / best / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t dist = (uint64_t) 3e8;
+  if (argc > 1)
+    dist = std::strtoull(argv[1], nullptr, 10);
+
+  uint64_t max = ~0ull - 1000;
+  std::cout << std::fixed << std::setprecision(1);
+
+  for (uint64_t start : { (uint64_t) 1e10, (uint64_t) 1e13, (uint64_t) 1e16, max - dist })
+  {
+    uint64_t stop = start + dist;
+    uint64_t sum1 = 0;
+    uint64_t sum2 = 0;
+    double speed1 = nextPrime(start, stop, sum1);
+    double speed2 = prevPrime(start, stop, sum2);
+
+    std::cout << "[" << start << ", " << stop << "]: "
+              << "next_prime() " << speed1 << " M primes/s, "
+              << "prev_prime() " << speed2 << " M primes/s"
+              << ((sum1 == sum2) ? "" : " (sum mismatch!)") << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,48 @@
+# We use GCC/Clang's function attribute target("avx2") to build
+# an AVX2 version of some hot functions. At runtime we check
+# using CPUID whether the CPU supports AVX2 and dispatch to the
+# AVX2 code path if it does, otherwise we use the default
+# (portable) code path.
+
+include(CheckCXXSourceCompiles)
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+    #include <cstddef>
+
+    __attribute__ ((target (\"avx2\")))
+    void and_avx2(const uint8_t* buf1, const uint8_t* buf2, uint8_t* output, std::size_t bytes)
+    {
+      for (std::size_t i = 0; i + 32 <= bytes; i += 32)
+      {
+        __m256i v1 = _mm256_loadu_si256((const __m256i*) &buf1[i]);
+        __m256i v2 = _mm256_loadu_si256((const __m256i*) &buf2[i]);
+        _mm256_storeu_si256((__m256i*) &output[i], _mm256_and_si256(v1, v2));
+      }
+    }
+
+    void and_default(const uint8_t* buf1, const uint8_t* buf2, uint8_t* output, std::size_t bytes)
+    {
+      for (std::size_t i = 0; i < bytes; i++)
+        output[i] = buf1[i] & buf2[i];
+    }
+
+    int main(int argc, char**)
+    {
+      uint8_t buf1[64] = { 0xff };
+      uint8_t buf2[64] = { 0x0f };
+      uint8_t output[64];
+
+      if (argc > 1)
+        and_avx2(buf1, buf2, output, 64);
+      else
+        and_default(buf1, buf2, output, 64);
+
+      return (output[0] == 0x0f) ? 0 : 1;
+    }
+" multiarch_avx2)
+
+if(multiarch_avx2)
+    list(APPEND PRIMESIEVE_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX2")
+endif()
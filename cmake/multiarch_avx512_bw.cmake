@@ -0,0 +1,47 @@
+# We use GCC/Clang's function attribute target("avx512bw") to
+# build an AVX512 version of some hot functions. At runtime we
+# check using CPUID whether the CPU supports AVX512 BW and
+# dispatch to the AVX512 code path if it does, otherwise we use
+# the default (portable) code path.
+
+include(CheckCXXSourceCompiles)
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+    #include <cstddef>
+
+    __attribute__ ((target (\"avx512f,avx512bw\")))
+    void and_avx512(const uint8_t* buf1, const uint8_t* buf2, uint8_t* output, std::size_t bytes)
+    {
+      __mmask64 mask = 0xffffffffffffffffull >> (64 - bytes);
+      __m512i v1 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) buf1);
+      __m512i v2 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) buf2);
+      __m512i v3 = _mm512_ternarylogic_epi64(v1, v2, v2, 0x80);
+      _mm512_mask_storeu_epi8((__m512i*) output, mask, v3);
+    }
+
+    void and_default(const uint8_t* buf1, const uint8_t* buf2, uint8_t* output, std::size_t bytes)
+    {
+      for (std::size_t i = 0; i < bytes; i++)
+        output[i] = buf1[i] & buf2[i];
+    }
+
+    int main(int argc, char**)
+    {
+      uint8_t buf1[64] = { 0xff };
+      uint8_t buf2[64] = { 0x0f };
+      uint8_t output[64];
+
+      if (argc > 1)
+        and_avx512(buf1, buf2, output, 64);
+      else
+        and_default(buf1, buf2, output, 64);
+
+      return (output[0] == 0x0f) ? 0 : 1;
+    }
+" multiarch_avx512_bw)
+
+if(multiarch_avx512_bw)
+    list(APPEND PRIMESIEVE_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX512_BW")
+endif()
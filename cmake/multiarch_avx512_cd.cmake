@@ -0,0 +1,55 @@
+# We use GCC/Clang's function attribute target("avx512cd") to
+# build an AVX512 version of EratBig::crossOff() which uses
+# gather/scatter instructions together with conflict detection.
+# At runtime we check using CPUID whether the CPU supports
+# AVX512 CD and dispatch to the AVX512 code path if it does,
+# otherwise we use the default (portable) code path.
+
+include(CheckCXXSourceCompiles)
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+
+    __attribute__ ((target (\"avx512f,avx512cd\")))
+    void clear_avx512(uint32_t* array, const uint32_t* indexes)
+    {
+      __m512i idx = _mm512_loadu_si512((const __m512i*) indexes);
+      __m512i conflicts = _mm512_conflict_epi32(idx);
+      if (_mm512_test_epi32_mask(conflicts, conflicts) == 0)
+      {
+        __m512i v = _mm512_i32gather_epi32(idx, (const void*) array, 4);
+        v = _mm512_andnot_si512(_mm512_set1_epi32(1), v);
+        _mm512_i32scatter_epi32((void*) array, idx, v, 4);
+      }
+    }
+
+    void clear_default(uint32_t* array, const uint32_t* indexes)
+    {
+      for (int i = 0; i < 16; i++)
+        array[indexes[i]] &= ~1u;
+    }
+
+    int main(int argc, char**)
+    {
+      uint32_t array[16];
+      uint32_t indexes[16];
+
+      for (int i = 0; i < 16; i++)
+      {
+        array[i] = 3;
+        indexes[i] = i;
+      }
+
+      if (argc > 1)
+        clear_avx512(array, indexes);
+      else
+        clear_default(array, indexes);
+
+      return (array[0] == 2) ? 0 : 1;
+    }
+" multiarch_avx512_cd)
+
+if(multiarch_avx512_cd)
+    list(APPEND PRIMESIEVE_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX512_CD")
+endif()
@@ -0,0 +1,45 @@
+# We use GCC/Clang's function attribute target("avx512vbmi2")
+# to build an AVX512 version of PrimeGenerator::fillNextPrimes()
+# which uses the vpcompressb and vpermb instructions. At runtime
+# we check using CPUID whether the CPU supports AVX512 VBMI2 and
+# dispatch to the AVX512 code path if it does, otherwise we use
+# the AVX2 or default (portable) code path.
+
+include(CheckCXXSourceCompiles)
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+
+    __attribute__ ((target (\"avx512f,avx512bw,avx512vbmi,avx512vbmi2\")))
+    void compress_avx512(uint64_t bits, uint64_t* output)
+    {
+      __m512i indexes = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+      __m512i bytes = _mm512_maskz_set1_epi8(bits, (char) 0xff);
+      bytes = _mm512_maskz_compress_epi8(bits, bytes);
+      __m512i v = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, indexes, bytes);
+      _mm512_storeu_si512(output, v);
+    }
+
+    void compress_default(uint64_t bits, uint64_t* output)
+    {
+      for (int i = 0; i < 8; i++)
+        output[i] = (bits >> i) & 1 ? 0xff : 0;
+    }
+
+    int main(int argc, char**)
+    {
+      uint64_t output[8];
+
+      if (argc > 1)
+        compress_avx512(0xff, output);
+      else
+        compress_default(0xff, output);
+
+      return (output[0] == 0xff) ? 0 : 1;
+    }
+" multiarch_avx512_vbmi2)
+
+if(multiarch_avx512_vbmi2)
+    list(APPEND PRIMESIEVE_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX512_VBMI2")
+endif()
@@ -0,0 +1,49 @@
+# We use GCC/Clang's function attribute target("avx512vpopcntdq")
+# to build an AVX512 version of popcount() which uses the
+# vpopcntq instruction. At runtime we check using CPUID whether
+# the CPU supports AVX512 VPOPCNTDQ and dispatch to the AVX512
+# code path if it does, otherwise we use the AVX2 or default
+# (portable) code path.
+
+include(CheckCXXSourceCompiles)
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+
+    __attribute__ ((target (\"avx512f,avx512vpopcntdq\")))
+    uint64_t popcnt_avx512(const uint64_t* array)
+    {
+      __m512i v = _mm512_maskz_loadu_epi64(0xff, (const __m512i*) array);
+      return _mm512_reduce_add_epi64(_mm512_popcnt_epi64(v));
+    }
+
+    uint64_t popcnt_default(const uint64_t* array)
+    {
+      uint64_t cnt = 0;
+      for (int i = 0; i < 8; i++)
+        for (uint64_t x = array[i]; x; x &= x - 1)
+          cnt++;
+      return cnt;
+    }
+
+    int main(int argc, char**)
+    {
+      uint64_t array[8];
+
+      for (int i = 0; i < 8; i++)
+        array[i] = i;
+
+      uint64_t cnt;
+      if (argc > 1)
+        cnt = popcnt_avx512(array);
+      else
+        cnt = popcnt_default(array);
+
+      return (cnt == 12) ? 0 : 1;
+    }
+" multiarch_avx512_vpopcnt)
+
+if(multiarch_avx512_vpopcnt)
+    list(APPEND PRIMESIEVE_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX512_VPOPCNT")
+endif()
@@ -78,6 +78,46 @@ void* primesieve_generate_primes(uint64_t start, uint64_t stop, size_t* size, in
  */
 void* primesieve_generate_n_primes(uint64_t n, uint64_t start, int type);
 
+/**
+ * Opaque container which stores primes using about 1 byte per
+ * prime (instead of 8 bytes for uint64_t), each prime is stored
+ * as the gap to the previous prime in varint encoding.
+ */
+typedef struct primesieve_compressed_primes primesieve_compressed_primes;
+
+/**
+ * Get a compressed primes container with the primes inside
+ * [start, stop]. The container must be deallocated using
+ * primesieve_free_compressed_primes(). Returns NULL if an
+ * error occurs.
+ */
+primesieve_compressed_primes* primesieve_generate_compressed_primes(uint64_t start, uint64_t stop);
+
+/**
+ * Append the primes inside [start, stop] to the compressed primes
+ * container, start must be > the largest prime in the container.
+ * Returns the new number of primes in the container.
+ */
+uint64_t primesieve_append_compressed_primes(primesieve_compressed_primes* primes, uint64_t start, uint64_t stop);
+
+/** Number of primes in the compressed primes container */
+size_t primesieve_compressed_primes_size(const primesieve_compressed_primes* primes);
+
+/** Memory usage of the compressed primes container in bytes */
+size_t primesieve_compressed_primes_bytes(const primesieve_compressed_primes* primes);
+
+/**
+ * Decode the primes with index [i, i + n[ into the buffer and return
+ * the number of primes decoded (< n at the end of the container).
+ * Each call has to decode the primes from the start of the block
+ * containing the i-th prime, hence for fast scans n should be
+ * large (e.g. >= 64 * 1024).
+ */
+size_t primesieve_decode_compressed_primes(const primesieve_compressed_primes* primes, size_t i, uint64_t* buffer, size_t n);
+
+/** Deallocate a compressed primes container */
+void primesieve_free_compressed_primes(primesieve_compressed_primes* primes);
+
 /**
  * Find the nth prime.
  * By default all CPU cores are used, use
@@ -152,6 +192,38 @@ uint64_t primesieve_count_quintuplets(uint64_t start, uint64_t stop);
  */
 uint64_t primesieve_count_sextuplets(uint64_t start, uint64_t stop);
 
+/**
+ * Count the primes within the interval [start, stop] in each
+ * residue class modulo q. Returns an array of size q whose
+ * element a is the number of primes p inside [start, stop]
+ * with p % q == a. The array must be deallocated using
+ * primesieve_free(). By default all CPU cores are used, use
+ * primesieve_set_num_threads(int threads) to change the
+ * number of threads.
+ *
+ * @pre q > 0 && q <= 2^20.
+ *
+ * If an error occurs (e.g. q = 0 or q > 2^20) NULL is returned
+ * and errno is set to EDOM.
+ */
+uint64_t* primesieve_count_primes_mod(uint64_t start, uint64_t stop, uint64_t q);
+
+/**
+ * Count the prime constellations within the interval
+ * [start, stop]. A constellation is found at p if
+ * p + pattern[i] is prime for all i < size and all of its
+ * primes are inside [start, stop], e.g. pattern = { 0, 4 }
+ * counts the cousin primes. pattern[0] must be 0, the
+ * pattern must be strictly increasing and
+ * pattern[size - 1] <= 2^16. By default all CPU cores are
+ * used, use primesieve_set_num_threads(int threads) to
+ * change the number of threads.
+ *
+ * If an error occurs (e.g. invalid pattern)
+ * PRIMESIEVE_ERROR is returned and errno is set to EDOM.
+ */
+uint64_t primesieve_count_constellations(uint64_t start, uint64_t stop, const uint64_t* pattern, size_t size);
+
 /**
  * Print the primes within the interval [start, stop]
  * to the standard output.
@@ -188,6 +260,48 @@ void primesieve_print_quintuplets(uint64_t start, uint64_t stop);
  */
 void primesieve_print_sextuplets(uint64_t start, uint64_t stop);
 
+/**
+ * Print the prime constellations within the interval
+ * [start, stop] to the standard output,
+ * see primesieve_count_constellations().
+ */
+void primesieve_print_constellations(uint64_t start, uint64_t stop, const uint64_t* pattern, size_t size);
+
+/**
+ * Callback of primesieve_sieve_bitmap(), data is the
+ * user pointer passed to primesieve_sieve_bitmap().
+ */
+typedef void (*primesieve_bitmap_callback)(uint64_t low, const uint8_t* bits, size_t bytes, void* data);
+
+/**
+ * Sieve the interval [start, stop] and pass the sieve array
+ * of each segment to the callback, without copying and without
+ * generating the primes. Bit i (least significant bit = bit 0)
+ * of bits[j] corresponds to the number
+ * low + 30 * j + { 7, 11, 13, 17, 19, 23, 29, 31 }[i]
+ * and it is set if that number is prime. low is a multiple of
+ * 30. bits is 8-byte aligned and zero padded up to the next
+ * multiple of 8 bytes, hence it can be processed as
+ * ceil(bytes / 8) uint64_t words. The bits of the numbers
+ * < start or > stop are unset. The primes
+ * 2, 3 and 5 are not part of the sieve array. The bits pointer
+ * is only valid during the callback. The segments are delivered
+ * in increasing order and do not overlap.
+ */
+void primesieve_sieve_bitmap(uint64_t start, uint64_t stop, primesieve_bitmap_callback callback, void* data);
+
+/**
+ * Same as primesieve_sieve_bitmap() but uses multi-threading.
+ * If ordered != 0 the segments are delivered in increasing order
+ * and the callback is never executed concurrently. If ordered == 0
+ * the segments are delivered in any order and the callback is
+ * executed concurrently by multiple threads.
+ * By default all CPU cores are used, use
+ * primesieve_set_num_threads(int threads) to change the
+ * number of threads.
+ */
+void primesieve_parallel_sieve_bitmap(uint64_t start, uint64_t stop, primesieve_bitmap_callback callback, void* data, int ordered);
+
 /**
  * Returns the largest valid stop number for primesieve.
  * @return 2^64-1 (UINT64_MAX).
@@ -215,10 +329,23 @@ void primesieve_set_sieve_size(int sieve_size);
  */
 void primesieve_set_num_threads(int num_threads);
 
+/**
+ * Find the fastest sieve size and EratSmall/EratMedium
+ * thresholds for the current machine by running prime
+ * counting benchmarks (takes about 15 seconds). The
+ * settings are saved to the tune file which is
+ * $PRIMESIEVE_TUNE_FILE or ~/.primesieve_tune, they are
+ * used by the current process and by all later processes
+ * that run on the same CPU. Sets errno to EDOM if an
+ * error occurs (e.g. the tune file cannot be written).
+ */
+void primesieve_tune();
+
 /**
  * Deallocate a primes array created using the
  * primesieve_generate_primes() or primesieve_generate_n_primes()
- * functions.
+ * functions or a counts array created using
+ * primesieve_count_primes_mod().
  */
 void primesieve_free(void* primes);
 
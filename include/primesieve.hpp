@@ -17,11 +17,16 @@
 #define PRIMESIEVE_VERSION_MAJOR 7
 #define PRIMESIEVE_VERSION_MINOR 9
 
+#include <primesieve/compressed_primes.hpp>
+#include <primesieve/ForEachPrime.hpp>
 #include <primesieve/iterator.hpp>
 #include <primesieve/primesieve_error.hpp>
 #include <primesieve/StorePrimes.hpp>
 
 #include <stdint.h>
+#include <cstddef>
+#include <functional>
+#include <utility>
 #include <vector>
 #include <string>
 
@@ -37,7 +42,9 @@ inline void generate_primes(uint64_t stop, std::vector<T>* primes)
 }
 
 /// Store the primes within the interval [start, stop]
-/// in the primes vector.
+/// in the primes vector. By default all CPU cores are used
+/// for large intervals, use primesieve::set_num_threads(int
+/// threads) to change the number of threads.
 ///
 template <typename T>
 inline void generate_primes(uint64_t start, uint64_t stop, std::vector<T>* primes)
@@ -46,6 +53,25 @@ inline void generate_primes(uint64_t start, uint64_t stop, std::vector<T>* prime
     store_primes(start, stop, *primes);
 }
 
+/// Append the primes <= stop to the compressed
+/// primes container (about 1 byte per prime).
+///
+inline void generate_primes(uint64_t stop, compressed_primes* primes)
+{
+  if (primes)
+    store_primes(0, stop, *primes);
+}
+
+/// Append the primes within the interval [start, stop]
+/// to the compressed primes container (about 1 byte
+/// per prime).
+///
+inline void generate_primes(uint64_t start, uint64_t stop, compressed_primes* primes)
+{
+  if (primes)
+    store_primes(start, stop, *primes);
+}
+
 /// Store the first n primes in the primes vector.
 template <typename T>
 inline void generate_n_primes(uint64_t n, std::vector<T>* primes)
@@ -55,6 +81,10 @@ inline void generate_n_primes(uint64_t n, std::vector<T>* primes)
 }
 
 /// Store the first n primes >= start in the primes vector.
+/// By default all CPU cores are used for large n, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
 template <typename T>
 inline void generate_n_primes(uint64_t n, uint64_t start, std::vector<T>* primes)
 {
@@ -89,10 +119,24 @@ uint64_t nth_prime(int64_t n, uint64_t start = 0);
 /// overhead of O(sqrt(stop)) even if the interval [start, stop]
 /// is tiny. Hence if you have written an algorithm that makes
 /// many calls to count_primes() it may be preferable to use
-/// a primesieve::iterator which needs to be initialized only once.
+/// a primesieve::iterator which needs to be initialized only once
+/// or count_primes_batch().
 ///
 uint64_t count_primes(uint64_t start, uint64_t stop);
 
+/// Count the primes inside each of the intervals [start, stop].
+/// The sieving primes are generated only once for all
+/// intervals and overlapping intervals are sieved only once,
+/// hence this is much faster than calling count_primes()
+/// for each interval.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+/// @return counts[i] = number of primes inside intervals[i].
+///
+std::vector<uint64_t> count_primes_batch(const std::vector<std::pair<uint64_t, uint64_t>>& intervals);
+
 /// Count the twin primes within the interval [start, stop].
 /// By default all CPU cores are used, use
 /// primesieve::set_num_threads(int threads) to change the
@@ -128,6 +172,70 @@ uint64_t count_quintuplets(uint64_t start, uint64_t stop);
 ///
 uint64_t count_sextuplets(uint64_t start, uint64_t stop);
 
+/// Count the primes within the interval [start, stop] in
+/// each residue class modulo q. Returns a vector of size q
+/// whose element a is the number of primes p inside
+/// [start, stop] with p % q == a. All residue classes are
+/// counted in a single pass over the sieve array.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+/// @pre q > 0 && q <= 2^20.
+///
+std::vector<uint64_t> count_primes_mod(uint64_t start, uint64_t stop, uint64_t q);
+
+/// Count the prime constellations within the interval
+/// [start, stop]. A constellation is found at p if
+/// p + pattern[i] is prime for all i and all of its primes
+/// are inside [start, stop]. E.g. pattern = { 0, 4 } counts
+/// the cousin primes, { 0, 2, 6, 8, 12 } counts the prime
+/// quintuplets of the form (p, p+2, p+6, p+8, p+12).
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+/// @pre pattern[0] = 0, pattern is strictly increasing and
+///      pattern.back() <= 2^16.
+///
+uint64_t count_constellations(uint64_t start, uint64_t stop, const std::vector<uint64_t>& pattern);
+
+#if defined(__SIZEOF_INT128__)
+
+/// Unsigned 128-bit integer (GCC & Clang extension),
+/// __extension__ silences -Wpedantic in user code.
+///
+__extension__ typedef unsigned __int128 uint128_t;
+
+/// Sum of the primes within the interval [start, stop].
+/// The sum is computed directly from the sieve array
+/// without generating the primes.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+uint128_t sum_primes(uint64_t start, uint64_t stop);
+
+/// Sum of the squares of the primes within the interval
+/// [start, stop]. Throws a primesieve_error if the
+/// result does not fit into 128 bits.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+uint128_t sum_prime_squares(uint64_t start, uint64_t stop);
+
+#endif
+
+/// Sum of the natural logarithms of the primes within the
+/// interval [start, stop]. For start = 0 this is Chebyshev's
+/// theta function theta(stop).
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+double sum_log_primes(uint64_t start, uint64_t stop);
+
 /// Print the primes within the interval [start, stop]
 /// to the standard output.
 ///
@@ -158,6 +266,102 @@ void print_quintuplets(uint64_t start, uint64_t stop);
 ///
 void print_sextuplets(uint64_t start, uint64_t stop);
 
+/// Print the prime constellations within the interval
+/// [start, stop] to the standard output,
+/// see count_constellations().
+///
+void print_constellations(uint64_t start, uint64_t stop, const std::vector<uint64_t>& pattern);
+
+/// Callback of sieve_bitmap(): low, bits, bytes.
+using bitmap_callback = std::function<void(uint64_t, const uint8_t*, std::size_t)>;
+
+/// Sieve the interval [start, stop] and pass the sieve array
+/// of each segment to the callback, without copying and
+/// without generating the primes. The sieve array uses 8 bits
+/// for 30 numbers: bit i (least significant bit = bit 0) of
+/// bits[j] corresponds to the number
+/// low + 30 * j + { 7, 11, 13, 17, 19, 23, 29, 31 }[i]
+/// and it is set if that number is prime. low is a multiple
+/// of 30. bits is 8-byte aligned and zero padded up to the
+/// next multiple of 8 bytes, hence bits can be processed as
+/// ceil(bytes / 8) uint64_t words (on little endian CPUs bit
+/// k of word w is bit k % 8 of byte 8 * w + k / 8). The bits
+/// of the numbers < start or > stop are unset. The primes 2,
+/// 3 and 5 are not part of the sieve array. The bits pointer
+/// is only valid during the callback. The segments are
+/// delivered in increasing order and do not overlap.
+///
+void sieve_bitmap(uint64_t start, uint64_t stop, const bitmap_callback& callback);
+
+/// Same as sieve_bitmap() but uses multi-threading. If
+/// ordered = true the segments are delivered in increasing
+/// order and the callback is never executed concurrently,
+/// segments that are sieved ahead of their turn are copied
+/// into a buffer. If ordered = false the segments are
+/// delivered without copying in any order and the callback
+/// is executed concurrently by multiple threads, hence it
+/// must be thread-safe. The segments never overlap.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+void parallel_sieve_bitmap(uint64_t start, uint64_t stop, const bitmap_callback& callback, bool ordered = true);
+
+/// Call f(prime) for each prime within the interval
+/// [start, stop] in increasing order. The sieve array of
+/// each segment is decoded inside the caller's translation
+/// unit, hence f is inlined into the decoding loop.
+///
+template <typename F>
+inline void for_each_prime(uint64_t start, uint64_t stop, F&& f)
+{
+  for (uint64_t p : { 2, 3, 5 })
+    if (p >= start && p <= stop)
+      f(p);
+
+  auto segment = [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+  {
+    for_each_prime_segment(low, bits, bytes, f);
+  };
+
+  sieve_bitmap(start, stop, segment);
+}
+
+/// Same as for_each_prime() but uses multi-threading, the
+/// primes are visited in arbitrary order. Each thread uses
+/// its own copy of f (copied from f before any prime is
+/// visited), afterwards all copies are merged into the
+/// returned result = f using reduce(F& result, const F& copy).
+/// Hence f should initially hold the identity of the
+/// reduction, e.g. sum = 0.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+///
+template <typename F, typename R>
+inline F parallel_for_each_prime(uint64_t start, uint64_t stop, F f, R reduce)
+{
+  const F init = f;
+  ForEachPrimeStates<F> states(init);
+
+  for (uint64_t p : { 2, 3, 5 })
+    if (p >= start && p <= stop)
+      f(p);
+
+  // The segments are delivered concurrently
+  auto segment = [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+  {
+    F* state = states.acquire();
+    for_each_prime_segment(low, bits, bytes, *state);
+    states.release(state);
+  };
+
+  parallel_sieve_bitmap(start, stop, segment, false);
+
+  states.reduce(f, reduce);
+  return f;
+}
+
 /// Returns the largest valid stop number for primesieve.
 /// @return 2^64-1 (UINT64_MAX).
 ///
@@ -182,6 +386,44 @@ void set_sieve_size(int sieve_size);
 ///
 void set_num_threads(int num_threads);
 
+/// Find the fastest sieve size and EratSmall/EratMedium
+/// thresholds for the current machine by running prime
+/// counting benchmarks (takes about 15 seconds). The
+/// settings are saved to the tune file which is
+/// $PRIMESIEVE_TUNE_FILE or ~/.primesieve_tune, they are
+/// used by the current process and by all later processes
+/// that run on the same CPU. A sieve size set using
+/// set_sieve_size() takes precedence.
+///
+/// tune() is thread-safe, but other threads that are
+/// using primesieve at the same time distort its
+/// benchmarks.
+///
+void tune();
+
+/// Build a pi(x) index file that stores the number of primes
+/// below each checkpoint step, 2 * step, 3 * step, ... <= stop.
+/// Once the index has been loaded using set_pi_index() (or
+/// using the PRIMESIEVE_PI_INDEX environment variable),
+/// count_primes() and nth_prime() only need to sieve the
+/// distance between the interval bounds and the nearest
+/// checkpoints. A smaller step makes queries faster but
+/// the index file larger (8 bytes per checkpoint).
+/// By default all CPU cores are used.
+///
+void build_pi_index(const std::string& filename, uint64_t stop, uint64_t step = 1ull << 28);
+
+/// Load the pi(x) index file used by count_primes() and
+/// nth_prime(), an empty filename unloads the index.
+/// By default the index file $PRIMESIEVE_PI_INDEX is
+/// loaded (if that environment variable is set).
+/// Throws a primesieve_error if the file is not
+/// a valid index file. set_pi_index() is thread-safe,
+/// threads that are currently using the old index
+/// keep using it until they have finished.
+///
+void set_pi_index(const std::string& filename);
+
 /// Get the primesieve version number, in the form “i.j”.
 std::string primesieve_version();
 
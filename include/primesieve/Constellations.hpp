@@ -0,0 +1,91 @@
+///
+/// @file   Constellations.hpp
+/// @brief  Count and print user-defined prime constellations
+///         e.g. { 0, 4 } cousin primes, { 0, 6 } sexy primes or
+///         { 0, 2, 6, 8, 12 }. Used by PrintPrimes if the
+///         COUNT_CONSTELLATIONS or PRINT_CONSTELLATIONS flags
+///         are set.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CONSTELLATIONS_HPP
+#define CONSTELLATIONS_HPP
+
+#include <stdint.h>
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+namespace primesieve {
+
+class Constellations
+{
+public:
+  void init(const std::vector<uint64_t>& pattern,
+            uint64_t maxFirstPrime,
+            bool print);
+  void addSegment(const uint8_t* sieve, uint64_t bytes, uint64_t low);
+  void finish();
+  uint64_t getCount() const { return count_; }
+
+private:
+  /// The number p + pattern[j] is located in the sieve
+  /// byte (byte of p) + byte at bit (bit of p) + shift.
+  /// The sieve word is shifted right by rshift and left by
+  /// lshift so that its bit corresponds to the bit of p.
+  struct Term
+  {
+    uint64_t byte;
+    uint64_t rshift;
+    uint64_t lshift;
+    bool operator==(const Term& other) const
+    {
+      return byte == other.byte &&
+             rshift == other.rshift &&
+             lshift == other.lshift;
+    }
+  };
+
+  /// The bits of the sieve bytes (mask) that correspond
+  /// to the first prime p of a constellation and the
+  /// range of their terms [begin, end[. Bits with
+  /// identical terms share the same First. Only the bits
+  /// for which the pattern is admissible modulo 2, 3 and
+  /// 5 are stored.
+  struct First
+  {
+    uint64_t mask;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  std::vector<First> first_;
+  std::vector<Term> terms_;
+  /// Largest byte offset of all terms
+  uint64_t maxByte_ = 0;
+  uint64_t maxFirstPrime_ = 0;
+  uint64_t count_ = 0;
+  bool print_ = false;
+  std::vector<uint64_t> pattern_;
+  /// Sieve bytes of the previous segment whose
+  /// constellations extend into the next segment.
+  std::vector<uint8_t> tail_;
+  uint64_t tailLow_ = 0;
+  std::vector<uint8_t> buffer_;
+  std::ostringstream out_;
+  /// Constellation bits of a block of sieve words
+  std::array<uint64_t, 512> block_;
+  std::array<uint64_t, 512> acc_;
+  void process(const uint8_t* sieve, uint64_t bytes, uint64_t low);
+  void found(uint64_t bits, uint64_t low);
+  void flush();
+};
+
+} // namespace
+
+#endif
@@ -16,6 +16,7 @@
 #include "EratBig.hpp"
 #include "macros.hpp"
 #include "intrinsics.hpp"
+#include "tune.hpp"
 
 #include <stdint.h>
 #include <array>
@@ -37,6 +38,7 @@ class Erat
 public:
   uint64_t getSieveSize() const;
   uint64_t getStop() const;
+  const TuneSettings& getTuneSettings() const;
 
 protected:
   /// Sieve primes >= start_
@@ -51,11 +53,17 @@ protected:
   uint64_t segmentHigh_ = 0;
   /// Sieve of Eratosthenes array
   uint8_t* sieve_ = nullptr;
+  /// Only count primes, enables the fused count pipeline
+  bool isCountOnly_ = false;
+  /// Tile size in bytes of the fused count pipeline,
+  /// 0 if the fused count pipeline is not used.
+  uint64_t tileSize_ = 0;
   Erat() = default;
   Erat(uint64_t, uint64_t);
-  void init(uint64_t, uint64_t, uint64_t, PreSieve&, MemoryPool& memoryPool);
+  void init(uint64_t, uint64_t, uint64_t, PreSieve&, MemoryPool& memoryPool, const TuneSettings&);
   void addSievingPrime(uint64_t);
   NOINLINE void sieveSegment();
+  NOINLINE uint64_t countSegment();
   bool hasNextSegment() const;
   static uint64_t nextPrime(uint64_t, uint64_t);
 
@@ -66,6 +74,7 @@ private:
   std::unique_ptr<uint8_t[]> deleter_;
   MemoryPool* memoryPool_ = nullptr;
   PreSieve* preSieve_ = nullptr;
+  TuneSettings tuneSettings_;
   EratSmall eratSmall_;
   EratBig eratBig_;
   EratMedium eratMedium_;
@@ -125,6 +134,11 @@ inline uint64_t Erat::getSieveSize() const
   return sieveSize_ >> 10;
 }
 
+inline const TuneSettings& Erat::getTuneSettings() const
+{
+  return tuneSettings_;
+}
+
 } // namespace
 
 #endif
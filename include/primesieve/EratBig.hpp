@@ -31,7 +31,11 @@ public:
   void init(uint64_t, uint64_t, uint64_t, MemoryPool*);
   NOINLINE void crossOff(uint8_t*);
   bool hasSievingPrimes() const { return !buckets_.empty(); }
+  void setAvx512(bool enable);
+  bool isAvx512() const { return avx512_; }
+  static bool useAvx512();
 private:
+  bool avx512_ = false;
   uint64_t maxPrime_ = 0;
   uint64_t log2SieveSize_ = 0;
   uint64_t moduloSieveSize_ = 0;
@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include <array>
+#include <vector>
 
 namespace primesieve {
 
@@ -23,19 +24,28 @@ class MemoryPool;
 
 /// EratMedium is an implementation of the segmented sieve of
 /// Eratosthenes optimized for medium sieving primes
-/// that have a few multiples per segment.
+/// that have a few multiples per segment. Large sieve arrays
+/// are processed in cache sized tiles.
 ///
 class EratMedium : public Wheel30_t
 {
 public:
-  void init(uint64_t, uint64_t, MemoryPool*);
+  void init(uint64_t, uint64_t, uint64_t, uint64_t, MemoryPool*);
   bool hasSievingPrimes() const { return hasSievingPrimes_; }
+  uint64_t getTileSize() const { return 1ull << log2TileSize_; }
   NOINLINE void crossOff(uint8_t*, uint64_t);
+  NOINLINE void crossOffTile(uint8_t*, uint64_t, uint64_t);
+  void nextSegment();
 private:
   bool hasSievingPrimes_ = false;
   uint64_t maxPrime_ = 0;
+  uint64_t sieveSize_ = 0;
+  uint64_t log2TileSize_ = 0;
   MemoryPool* memoryPool_ = nullptr;
-  std::array<SievingPrime*, 64> buckets_;
+  /// 64 bucket lists (one per wheelIndex) per tile
+  std::vector<std::array<SievingPrime*, 64>> buckets_;
+  /// Bucket lists of the next segment
+  std::vector<std::array<SievingPrime*, 64>> nextBuckets_;
   void storeSievingPrime(uint64_t, uint64_t, uint64_t);
   NOINLINE void crossOff_7(uint8_t*, uint8_t*, Bucket*);
   NOINLINE void crossOff_11(uint8_t*, uint8_t*, Bucket*);
@@ -23,18 +23,43 @@ namespace primesieve {
 /// of Eratosthenes optimized for small sieving primes that
 /// have many multiples per segment.
 ///
+/// The smallest sieving primes (<= maxPatternPrime) are not
+/// crossed off one multiple at a time. Instead we precompute
+/// a periodic bit pattern for each of these primes and AND
+/// it into the sieve array using wide vector instructions.
+///
 class EratSmall : public Wheel30_t
 {
 public:
   static uint64_t getL1CacheSize(uint64_t);
-  void init(uint64_t, uint64_t, uint64_t);
+  void init(uint64_t, uint64_t, uint64_t, uint64_t maxPatternPrime = 0);
+  void addSievingPrime(uint64_t, uint64_t);
   void crossOff(uint8_t*, uint64_t);
-  bool hasSievingPrimes() const { return !primes_.empty(); }
+  bool hasSievingPrimes() const { return !primes_.empty() || !patternPrimes_.empty(); }
 private:
+  struct PatternPrime
+  {
+    /// Index of the prime's pattern in patterns_
+    uint64_t offset;
+    /// Pattern size in bytes, a multiple of the prime
+    uint64_t size;
+    /// Pattern byte corresponding to the next sieve byte
+    uint64_t pos;
+    /// Sieve byte containing the prime itself, the pattern
+    /// removes the prime, hence we have to restore its bit.
+    uint64_t primeIndex;
+    uint8_t primeBit;
+  };
+
   uint64_t maxPrime_ = 0;
+  uint64_t maxPatternPrime_ = 0;
   uint64_t l1CacheSize_ = 0;
   std::vector<SievingPrime> primes_;
+  std::vector<PatternPrime> patternPrimes_;
+  std::vector<uint8_t> patterns_;
   void storeSievingPrime(uint64_t, uint64_t, uint64_t);
+  void addPatternPrime(uint64_t, uint64_t);
+  void crossOffPatterns(uint8_t*, uint64_t);
   NOINLINE void crossOff(uint8_t*, uint8_t*);
 };
 
@@ -0,0 +1,191 @@
+///
+/// @file   ForEachPrime.hpp
+/// @brief  for_each_prime() decodes the sieve array of each
+///         segment (see sieve_bitmap()) inside the user's
+///         translation unit, hence the functor is inlined into
+///         the decoding loop. Unlike iterator::next_prime() there
+///         is no per prime buffer refill check and unlike
+///         generate_primes() no vector is materialized.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef FOREACHPRIME_HPP
+#define FOREACHPRIME_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+  #include <intrin.h>
+#endif
+
+namespace primesieve {
+
+/// Internal use, count trailing zeros, x != 0
+inline int ctz_for_each_prime(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long r;
+  _BitScanForward64(&r, x);
+  return (int) r;
+#else
+  // De Bruijn bitscan
+  static const int table[64] =
+  {
+     0, 47,  1, 56, 48, 27,  2, 60,
+    57, 49, 41, 37, 28, 16,  3, 61,
+    54, 58, 35, 52, 50, 42, 21, 44,
+    38, 32, 29, 23, 17, 11,  4, 62,
+    46, 55, 26, 59, 40, 36, 15, 53,
+    34, 51, 20, 43, 31, 22, 10, 45,
+    25, 39, 14, 33, 19, 30,  9, 24,
+    13, 18,  8, 12,  7,  6,  5, 63
+  };
+  return table[((x ^ (x - 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+#endif
+}
+
+/// Internal use, count the 1 bits
+inline int popcount_for_each_prime(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  return (int) __popcnt64(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ull);
+  x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+  return (int) ((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/// Internal use, call f(prime) for each prime of a sieve
+/// array segment (see sieve_bitmap()) in increasing order.
+/// Bit k of the 64-bit word i corresponds to the number
+/// low + 240 * i + 30 * (k / 8) + bitValues[k % 8].
+///
+/// Same algorithm as PrimeGenerator::fillPrimes_default():
+/// the 1 bits of each word are decoded 4 at a time into a
+/// small buffer (the loop count only depends on the number
+/// of 1 bits), this avoids one branch misprediction per
+/// word. Afterwards f is called for the primes of the
+/// buffer in a loop that the compiler can inline.
+///
+template <typename F>
+inline void for_each_prime_segment(uint64_t low,
+                                   const uint8_t* bits,
+                                   std::size_t bytes,
+                                   F& f)
+{
+  static const uint8_t offsets[64] =
+  {
+      7,  11,  13,  17,  19,  23,  29,  31,
+     37,  41,  43,  47,  49,  53,  59,  61,
+     67,  71,  73,  77,  79,  83,  89,  91,
+     97, 101, 103, 107, 109, 113, 119, 121,
+    127, 131, 133, 137, 139, 143, 149, 151,
+    157, 161, 163, 167, 169, 173, 179, 181,
+    187, 191, 193, 197, 199, 203, 209, 211,
+    217, 221, 223, 227, 229, 233, 239, 241
+  };
+
+  // Each word adds at most 64 primes and
+  // the decoding loop writes up to 3 more.
+  const std::size_t maxSize = 512;
+  uint64_t primes[maxSize];
+
+  // The sieve array is zero padded to a multiple of 8 bytes
+  std::size_t words = (bytes + 7) / 8;
+  std::size_t i = 0;
+
+  while (i < words)
+  {
+    std::size_t size = 0;
+
+    for (; i < words && size <= maxSize - 68; i++, low += 240)
+    {
+      // Little endian load, compiles to a single
+      // load instruction on little endian CPUs.
+      const uint8_t* b = &bits[i * 8];
+      uint64_t word = (uint64_t) b[0] << 0 | (uint64_t) b[1] << 8 |
+                      (uint64_t) b[2] << 16 | (uint64_t) b[3] << 24 |
+                      (uint64_t) b[4] << 32 | (uint64_t) b[5] << 40 |
+                      (uint64_t) b[6] << 48 | (uint64_t) b[7] << 56;
+
+      std::size_t j = size;
+      size += popcount_for_each_prime(word);
+
+      // ctz(0) is undefined, bit 63 is set so that the
+      // surplus primes (which are never visited) are valid.
+      uint64_t x = word;
+      while (j < size)
+      {
+        primes[j+0] = low + offsets[ctz_for_each_prime(x | (1ull << 63))]; x &= x - 1;
+        primes[j+1] = low + offsets[ctz_for_each_prime(x | (1ull << 63))]; x &= x - 1;
+        primes[j+2] = low + offsets[ctz_for_each_prime(x | (1ull << 63))]; x &= x - 1;
+        primes[j+3] = low + offsets[ctz_for_each_prime(x | (1ull << 63))]; x &= x - 1;
+        j += 4;
+      }
+    }
+
+    for (std::size_t j = 0; j < size; j++)
+      f(primes[j]);
+  }
+}
+
+/// Internal use, per-thread functor states of
+/// parallel_for_each_prime(). Each segment is processed
+/// using an idle copy of the functor, hence there are at
+/// most as many copies as there are threads.
+///
+template <typename F>
+class ForEachPrimeStates
+{
+public:
+  ForEachPrimeStates(const F& init)
+    : init_(init)
+  { }
+  F* acquire()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.empty())
+    {
+      states_.emplace_back(new F(init_));
+      return states_.back().get();
+    }
+    F* state = idle_.back();
+    idle_.pop_back();
+    return state;
+  }
+  void release(F* state)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(state);
+  }
+  template <typename R>
+  void reduce(F& result, R& reduce)
+  {
+    for (auto& state : states_)
+      reduce(result, *state);
+  }
+
+private:
+  const F& init_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<F>> states_;
+  std::vector<F*> idle_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,94 @@
+///
+/// @file   GapStats.hpp
+/// @brief  Prime gap statistics: histogram of the gaps between
+///         consecutive primes, first occurrence of each gap size
+///         and maximal (record) gaps. Used by PrimeSieve if the
+///         COUNT_GAPS flag is set.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef GAPSTATS_HPP
+#define GAPSTATS_HPP
+
+#include "macros.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace primesieve {
+
+/// A maximal gap is a gap between consecutive primes that is
+/// larger than all gaps between smaller consecutive primes
+/// (inside the sieving interval).
+///
+struct MaximalGap
+{
+  uint64_t gap;
+  /// The prime that starts the gap
+  uint64_t prime;
+};
+
+class GapStats
+{
+public:
+  void reset();
+  /// Primes must be added in increasing order
+  void addPrime(uint64_t prime);
+  void addInterval(uint64_t firstPrime, uint64_t lastPrime);
+  void mergeGaps(const GapStats& other);
+  void append(const GapStats& next);
+  bool empty() const { return firstPrime_ == 0; }
+  uint64_t getFirstPrime() const { return firstPrime_; }
+  uint64_t getLastPrime() const { return lastPrime_; }
+  uint64_t getMaxGap() const;
+  uint64_t getCount(uint64_t gap) const;
+  uint64_t getFirstOccurrence(uint64_t gap) const;
+  const std::vector<uint64_t>& getHistogram() const { return histogram_; }
+  std::vector<MaximalGap> getMaximalGaps() const;
+
+private:
+  /// Smallest and largest prime inside the sieving interval
+  uint64_t firstPrime_ = 0;
+  uint64_t lastPrime_ = 0;
+  /// histogram_[gap] = number of gaps of size gap
+  std::vector<uint64_t> histogram_;
+  /// firstOccurrence_[gap] = smallest prime p such that
+  /// p + gap is the next prime, only valid if
+  /// histogram_[gap] > 0.
+  std::vector<uint64_t> firstOccurrence_;
+  void addGap(uint64_t prime, uint64_t nextPrime);
+};
+
+inline void GapStats::addPrime(uint64_t prime)
+{
+  if (lastPrime_)
+    addGap(lastPrime_, prime);
+  else
+    firstPrime_ = prime;
+
+  lastPrime_ = prime;
+}
+
+inline void GapStats::addGap(uint64_t prime, uint64_t nextPrime)
+{
+  uint64_t gap = nextPrime - prime;
+
+  if_unlikely(gap >= histogram_.size())
+  {
+    histogram_.resize(gap + 1, 0);
+    firstOccurrence_.resize(gap + 1, 0);
+  }
+
+  // Primes are added in increasing order, hence the
+  // first gap of each size is its first occurrence.
+  if_unlikely(histogram_[gap]++ == 0)
+    firstOccurrence_[gap] = prime;
+}
+
+} // namespace
+
+#endif
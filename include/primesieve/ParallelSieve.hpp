@@ -3,7 +3,7 @@
 /// @brief  The ParallelSieve class provides an easy API for
 ///         multi-threaded prime sieving.
 ///
-/// Copyright (C) 2019 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -15,13 +15,18 @@
 #include "PrimeSieve.hpp"
 #include <stdint.h>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace primesieve {
 
+class ParallelStore;
+
 class ParallelSieve : public PrimeSieve
 {
 public:
   using PrimeSieve::sieve;
+  using PrimeSieve::countPrimes;
 
   ParallelSieve();
   static int getMaxThreads();
@@ -30,12 +35,16 @@ public:
   void setNumThreads(int numThreads);
   bool tryUpdateStatus(uint64_t);
   virtual void sieve();
+  std::vector<uint64_t> countPrimes(const std::vector<std::pair<uint64_t, uint64_t>>&);
+  bool storePrimes(ParallelStore&);
+  void sieveBitmap(const BitmapCallback&, bool ordered);
 
 private:
   std::mutex mutex_;
   int numThreads_ = 0;
   uint64_t getThreadDistance(int) const;
   uint64_t align(uint64_t) const;
+  bool countPiIndex();
 };
 
 } // namespace
@@ -0,0 +1,73 @@
+///
+/// @file   PiIndex.hpp
+/// @brief  The pi(x) checkpoint index stores the number of primes
+///         below each multiple of a fixed step (e.g. 2^28). When
+///         an index has been loaded count_primes() and nth_prime()
+///         only sieve the (small) distance between the interval
+///         bounds and the nearest checkpoints.
+///
+///         The index file is built using primesieve::build_pi_index()
+///         or primesieve --build-pi-index=FILE and it is loaded
+///         using mmap(). File format (native byte order):
+///
+///         char     magic[8] = "PRIMEPI1"
+///         uint64_t step
+///         uint64_t size
+///         uint64_t pi[size]   pi[k - 1] = number of primes < k * step
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PIINDEX_HPP
+#define PIINDEX_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+class PiIndex
+{
+public:
+  PiIndex(const std::string& filename);
+  ~PiIndex();
+  PiIndex(const PiIndex&) = delete;
+  PiIndex& operator=(const PiIndex&) = delete;
+  uint64_t getStep() const { return step_; }
+  /// Number of checkpoints
+  uint64_t size() const { return size_; }
+  /// Largest checkpoint, size() * getStep()
+  uint64_t getMaxCheckpoint() const { return size_ * step_; }
+  /// Number of primes < k * getStep(), k <= size()
+  uint64_t getPi(uint64_t k) const { return (k > 0) ? pi_[k - 1] : 0; }
+  uint64_t nearestCheckpoint(uint64_t n) const;
+
+private:
+  const uint64_t* pi_ = nullptr;
+  uint64_t step_ = 0;
+  uint64_t size_ = 0;
+  /// Memory mapped index file
+  void* map_ = nullptr;
+  std::size_t mapBytes_ = 0;
+  /// Used if mmap() is not available
+  std::vector<uint64_t> buffer_;
+};
+
+/// Get the currently loaded pi(x) index or nullptr if no
+/// index is loaded. On first call the index file
+/// $PRIMESIEVE_PI_INDEX is loaded (if that environment
+/// variable is set). The index stays valid while the
+/// returned pointer is held, even if set_pi_index()
+/// unloads it concurrently.
+///
+std::shared_ptr<const PiIndex> getPiIndex();
+
+} // namespace
+
+#endif
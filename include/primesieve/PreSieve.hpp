@@ -1,7 +1,7 @@
 ///
 /// @file   PreSieve.hpp
-/// @brief  Pre-sieve multiples of small primes < 100 to speed up the
-///         sieve of Eratosthenes. The idea is to allocate several
+/// @brief  Pre-sieve multiples of small primes <= 167 to speed up
+///         the sieve of Eratosthenes. The idea is to allocate several
 ///         arrays (buffers_) and remove the multiples of small primes
 ///         from them at initialization. Each buffer is assigned
 ///         different primes, for example:
@@ -20,6 +20,13 @@
 ///         Pre-sieving provides a speedup of up to 30% when
 ///         sieving the primes < 10^10 using primesieve.
 ///
+///         For large sieving distances there is a second tier of
+///         7 buffers (buffersTier2_) that removes the multiples of
+///         the primes inside [101, 167]. The tier is chosen in
+///         init() based on the sieving distance and the CPU's L2
+///         cache size. The tier 2 buffers are ANDed into the
+///         already pre-sieved sieve array.
+///
 /// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -39,12 +46,13 @@ class PreSieve
 {
 public:
   void init(uint64_t start, uint64_t stop);
+  void initBuffers(int tier);
   void preSieve(uint8_t* sieve, uint64_t sieveSize, uint64_t segmentLow) const;
   uint64_t getMaxPrime() const { return maxPrime_; }
 private:
   uint64_t maxPrime_ = 13;
   std::array<std::vector<uint8_t>, 8> buffers_;
-  void initBuffers();
+  std::array<std::vector<uint8_t>, 7> buffersTier2_;
   static void preSieveSmall(uint8_t* sieve, uint64_t sieveSize, uint64_t segmentLow);
   void preSieveLarge(uint8_t* sieve, uint64_t sieveSize, uint64_t segmentLow) const;
 };
@@ -49,6 +49,10 @@ private:
   bool sievePrevPrimes(std::vector<uint64_t>&, std::size_t*);
   bool sieveNextPrimes(std::vector<uint64_t>&, std::size_t*);
   void sieveSegment();
+  void fillPrimes(std::vector<uint64_t>&, std::size_t*);
+  void fillPrimes_default(std::vector<uint64_t>&, std::size_t*);
+  void fillPrimes_avx2(std::vector<uint64_t>&, std::size_t*);
+  void fillPrimes_avx512(std::vector<uint64_t>&, std::size_t*);
 };
 
 } // namespace
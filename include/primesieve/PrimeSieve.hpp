@@ -4,7 +4,7 @@
 ///         sieving. It is used for printing and counting primes
 ///         and for computing the nth prime.
 ///
-/// Copyright (C) 2020 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -13,13 +13,21 @@
 #ifndef PRIMESIEVE_CLASS_HPP
 #define PRIMESIEVE_CLASS_HPP
 
+#include "GapStats.hpp"
 #include "PreSieve.hpp"
+#include "PrimeSums.hpp"
+#include "tune.hpp"
 #include <stdint.h>
 #include <array>
+#include <cstddef>
+#include <functional>
+#include <vector>
 
 namespace primesieve {
 
 using counts_t = std::array<uint64_t, 6>;
+/// SIEVE_BITMAP: low, sieve array, bytes
+using BitmapCallback = std::function<void(uint64_t, const uint8_t*, std::size_t)>;
 class ParallelSieve;
 
 enum
@@ -36,7 +44,15 @@ enum
   PRINT_QUADRUPLETS = 1 << 9,
   PRINT_QUINTUPLETS = 1 << 10,
   PRINT_SEXTUPLETS  = 1 << 11,
-  PRINT_STATUS      = 1 << 12
+  PRINT_STATUS      = 1 << 12,
+  COUNT_GAPS        = 1 << 13,
+  COUNT_PRIMES_MOD  = 1 << 14,
+  SUM_PRIMES        = 1 << 15,
+  SUM_PRIME_SQUARES = 1 << 16,
+  SUM_LOG_PRIMES    = 1 << 17,
+  COUNT_CONSTELLATIONS = 1 << 18,
+  PRINT_CONSTELLATIONS = 1 << 19,
+  SIEVE_BITMAP = 1 << 20
 };
 
 class PrimeSieve
@@ -52,17 +68,29 @@ public:
   int getSieveSize() const;
   double getSeconds() const;
   PreSieve& getPreSieve();
+  const TuneSettings& getTuneSettings() const;
   // Setters
   void setStart(uint64_t);
   void setStop(uint64_t);
   void updateStatus(uint64_t);
   void setSieveSize(int);
+  void setTuneSettings(const TuneSettings&);
   void setFlags(int);
+  void setModulus(uint64_t);
+  void setSievingPrimes(const std::vector<uint32_t>*);
+  void setPattern(const std::vector<uint64_t>&);
+  void setMaxFirstPrime(uint64_t);
+  void setBitmapCallback(const BitmapCallback*);
   void addFlags(int);
   // Bool is*
   bool isCount(int) const;
   bool isCountPrimes() const;
   bool isCountkTuplets() const;
+  bool isCountGaps() const;
+  bool isCountPrimesMod() const;
+  bool isSumPrimes() const;
+  bool isConstellation() const;
+  bool isBitmap() const;
   bool isPrint() const;
   bool isPrint(int) const;
   bool isPrintPrimes() const;
@@ -81,6 +109,21 @@ public:
   counts_t& getCounts();
   uint64_t getCount(int) const;
   uint64_t countPrimes(uint64_t, uint64_t);
+  // Prime gaps
+  GapStats& getGapStats();
+  // Primes in residue classes
+  uint64_t getModulus() const;
+  std::vector<uint64_t>& getModCounts();
+  // Sums of primes
+  PrimeSums& getPrimeSums();
+  // Shared sieving primes
+  const std::vector<uint32_t>* getSievingPrimes() const;
+  // Prime constellations
+  const std::vector<uint64_t>& getPattern() const;
+  uint64_t getMaxFirstPrime() const;
+  uint64_t& getConstellationCount();
+  // Sieve array of each segment
+  const BitmapCallback* getBitmapCallback() const;
 
 protected:
   /// Sieve primes >= start_
@@ -93,6 +136,15 @@ protected:
   double percent_ = 0;
   /// Prime number and prime k-tuplet counts
   counts_t counts_;
+  /// Prime gap statistics (COUNT_GAPS)
+  GapStats gapStats_;
+  /// modCounts_[a] = number of primes p with
+  /// p % modulus_ == a (COUNT_PRIMES_MOD)
+  std::vector<uint64_t> modCounts_;
+  /// SUM_PRIMES, SUM_PRIME_SQUARES, SUM_LOG_PRIMES
+  PrimeSums primeSums_;
+  /// Number of prime constellations (COUNT_CONSTELLATIONS)
+  uint64_t constellationCount_ = 0;
   void reset();
   void setStatus(double);
 
@@ -103,10 +155,26 @@ private:
   int flags_ = COUNT_PRIMES;
   /// Sieve size in KiB
   int sieveSize_ = 0;
+  /// EratSmall/EratMedium thresholds
+  TuneSettings tuneSettings_;
+  /// Modulus of the residue classes (COUNT_PRIMES_MOD)
+  uint64_t modulus_ = 1;
+  /// Sieving primes <= sqrt(stop) generated once and shared
+  /// by many sieve() calls, nullptr if the sieving primes
+  /// are generated on the fly (default).
+  const std::vector<uint32_t>* sievingPrimes_ = nullptr;
+  /// Prime constellation pattern e.g. { 0, 2, 6 }
+  std::vector<uint64_t> pattern_;
+  /// Only count constellations whose first prime
+  /// is <= maxFirstPrime_ (used for multi-threading).
+  uint64_t maxFirstPrime_ = ~0ull;
+  /// Called after each sieved segment (SIEVE_BITMAP)
+  const BitmapCallback* bitmapCallback_ = nullptr;
   /// Status updates must be synchronized by main thread
   ParallelSieve* parent_ = nullptr;
   PreSieve preSieve_;
   void processSmallPrimes();
+  void processSmallConstellations();
   static void printStatus(double, double);
 };
 
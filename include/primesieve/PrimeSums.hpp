@@ -0,0 +1,105 @@
+///
+/// @file   PrimeSums.hpp
+/// @brief  Sums of primes: sum of the primes, sum of the squares
+///         of the primes and sum of the logarithms of the primes
+///         (Chebyshev's theta function). Used by PrimeSieve if
+///         the SUM_PRIMES, SUM_PRIME_SQUARES or SUM_LOG_PRIMES
+///         flags are set.
+///
+///         The sum of the logarithms is computed as the product
+///         of the primes, stored as mantissa * 2^exponent. This
+///         is faster and more accurate than summing up the
+///         logarithms of the primes.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESUMS_HPP
+#define PRIMESUMS_HPP
+
+#include <stdint.h>
+#include <cmath>
+
+#if defined(__SIZEOF_INT128__)
+  #define PRIMESIEVE_INT128
+#endif
+
+namespace primesieve {
+
+#if defined(PRIMESIEVE_INT128)
+  __extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+struct PrimeSums
+{
+#if defined(PRIMESIEVE_INT128)
+  /// Sum of the primes, cannot overflow
+  /// as all primes are < 2^64.
+  uint128_t sum = 0;
+  /// Sum of the squares of the primes
+  uint128_t squares = 0;
+#endif
+  /// Set if the sum of squares is >= 2^128
+  bool squaresOverflow = false;
+  /// Product of the primes = mantissa * 2^exponent
+  double mantissa = 1;
+  int64_t exponent = 0;
+
+  void reset()
+  {
+    *this = PrimeSums();
+  }
+
+  /// Keep the mantissa inside [0.5, 1[
+  void normalize()
+  {
+    int e;
+    mantissa = std::frexp(mantissa, &e);
+    exponent += e;
+  }
+
+#if defined(PRIMESIEVE_INT128)
+  void addSquares(uint128_t x)
+  {
+    if (__builtin_add_overflow(squares, x, &squares))
+      squaresOverflow = true;
+  }
+#endif
+
+  /// Slow, used only for the primes 2, 3 and 5
+  void addPrime(uint64_t prime)
+  {
+#if defined(PRIMESIEVE_INT128)
+    sum += prime;
+    addSquares((uint128_t) prime * prime);
+#endif
+    mantissa *= (double) prime;
+    normalize();
+  }
+
+  void add(const PrimeSums& other)
+  {
+#if defined(PRIMESIEVE_INT128)
+    sum += other.sum;
+    addSquares(other.squares);
+#endif
+    squaresOverflow |= other.squaresOverflow;
+    mantissa *= other.mantissa;
+    exponent += other.exponent;
+    normalize();
+  }
+
+  /// Sum of the logarithms of the primes
+  double getLogSum() const
+  {
+    long double ln2 = 0.693147180559945309417232121458176568L;
+    return (double) (std::log((long double) mantissa) + exponent * ln2);
+  }
+};
+
+} // namespace
+
+#endif
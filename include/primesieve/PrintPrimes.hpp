@@ -10,13 +10,13 @@
 #ifndef PRINTPRIMES_HPP
 #define PRINTPRIMES_HPP
 
+#include "Constellations.hpp"
 #include "Erat.hpp"
 #include "MemoryPool.hpp"
 #include "macros.hpp"
 #include "PrimeSieve.hpp"
 
 #include <stdint.h>
-#include <vector>
 
 namespace primesieve {
 
@@ -33,16 +33,21 @@ public:
   NOINLINE void sieve();
 private:
   uint64_t low_ = 0;
-  /// Count lookup tables for prime k-tuplets
-  std::vector<uint8_t> kCounts_[6];
   counts_t& counts_;
   /// Reference to the associated PrimeSieve object
   PrimeSieve& ps_;
   MemoryPool memoryPool_;
-  void initCounts();
+  /// COUNT_CONSTELLATIONS, PRINT_CONSTELLATIONS
+  Constellations constellations_;
+  template <typename T>
+  void sieve(T& sievingPrimes);
   void print();
   void countPrimes();
   void countkTuplets();
+  void countGaps();
+  void countPrimesMod();
+  void sumPrimes();
+  void sieveBitmap() const;
   void printPrimes() const;
   void printkTuplets() const;
 };
@@ -1,8 +1,13 @@
 ///
 /// @file   StorePrimes.hpp
-/// @brief  Store primes in a vector.
+/// @brief  Store primes in a vector. Large intervals are stored
+///         using multi-threading: the primes of each chunk are
+///         first counted in parallel which gives the exact
+///         offset of each chunk's primes in the vector, after a
+///         single resize each thread generates the primes of its
+///         chunks directly into their slice of the vector.
 ///
-/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -39,6 +44,60 @@ inline std::size_t prime_count_approx(uint64_t start, uint64_t stop)
   return (std::size_t) pix;
 }
 
+/// Internal use, interface used by the library
+/// to store primes into the user's vector.
+///
+class ParallelStore
+{
+public:
+  virtual ~ParallelStore() = default;
+  /// Resize the vector to hold size more primes
+  virtual void resize(std::size_t size) = 0;
+  /// Store the next count primes <= stop into
+  /// the new primes at index offset.
+  virtual std::size_t fill(iterator& it,
+                           std::size_t offset,
+                           std::size_t count,
+                           uint64_t stop) = 0;
+};
+
+template <typename T>
+class VectorStore : public ParallelStore
+{
+public:
+  VectorStore(T& primes)
+    : primes_(primes),
+      size_(primes.size())
+  { }
+  void resize(std::size_t size) override
+  {
+    primes_.resize(size_ + size);
+  }
+  std::size_t fill(iterator& it,
+                   std::size_t offset,
+                   std::size_t count,
+                   uint64_t stop) override
+  {
+    return it.fill_primes(primes_.data() + size_ + offset, count, stop);
+  }
+
+private:
+  T& primes_;
+  std::size_t size_;
+};
+
+/// Internal use, store the primes inside [start, stop] using
+/// multi-threading. Returns false (and stores nothing) if
+/// the interval is too small for multi-threading.
+///
+bool store_primes_parallel(uint64_t start, uint64_t stop, ParallelStore& store);
+
+/// Internal use, store the first n primes > start using
+/// multi-threading. Returns false (and stores nothing) if
+/// n is too small for multi-threading.
+///
+bool store_n_primes_parallel(uint64_t n, uint64_t start, ParallelStore& store);
+
 template <typename T>
 inline void store_primes(uint64_t start,
                          uint64_t stop,
@@ -51,6 +110,10 @@ inline void store_primes(uint64_t start,
 
   if (start < stop)
   {
+    VectorStore<T> store(primes);
+    if (store_primes_parallel(start + 1, stop, store))
+      return;
+
     using V = typename T::value_type;
     std::size_t size = primes.size() + prime_count_approx(start, stop);
     primes.reserve(size);
@@ -72,6 +135,10 @@ inline void store_n_primes(uint64_t n,
   if (start > 0)
     start--;
 
+  VectorStore<T> store(primes);
+  if (store_n_primes_parallel(n, start, store))
+    return;
+
   std::size_t size = primes.size() + (std::size_t) n;
   primes.reserve(size);
   using V = typename T::value_type;
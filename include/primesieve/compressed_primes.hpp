@@ -0,0 +1,249 @@
+///
+/// @file   compressed_primes.hpp
+/// @brief  The compressed_primes container stores an increasing
+///         sequence of primes using about 1 byte per prime (instead
+///         of 8 bytes for uint64_t). Each prime is stored as the gap
+///         to the previous prime: gap / 2 is stored in varint
+///         encoding (7 bits per byte, the highest bit is set if more
+///         bytes follow). Below 10^12 all but a tiny fraction of the
+///         halved prime gaps are < 128 and hence use a single byte.
+///
+///         Every block_size primes there is a block header that
+///         stores the prime and the byte offset of the following gap,
+///         this provides random block access. Scanning the primes
+///         sequentially using the decoding iterator is mostly
+///         compute-bound and reads 8x less memory than scanning
+///         a std::vector<uint64_t>.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_COMPRESSED_PRIMES_HPP
+#define PRIMESIEVE_COMPRESSED_PRIMES_HPP
+
+#include "iterator.hpp"
+#include "primesieve_error.hpp"
+
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace primesieve {
+
+class compressed_primes
+{
+public:
+  /// Number of primes per block header
+  static constexpr std::size_t block_size = 1024;
+
+  /// Decoding (forward) iterator
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint64_t*;
+    using reference = uint64_t;
+
+    const_iterator() = default;
+    const_iterator(const uint8_t* gaps, uint64_t prime)
+      : gaps_(gaps),
+        prime_(prime)
+    { }
+
+    /// The prime 2 is stored as 1 internally so that all
+    /// gaps are even, this keeps the prime == 2 check out
+    /// of the decoding loop's dependency chain.
+    value_type operator*() const { return prime_ + (prime_ == 1); }
+
+    const_iterator& operator++()
+    {
+      prime_ += next_gap(gaps_);
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    /// Each prime has a unique gap position, incrementing the
+    /// iterator of the last prime consumes the sentinel gap
+    /// and moves it to the end of the gaps.
+    bool operator==(const const_iterator& other) const { return gaps_ == other.gaps_; }
+    bool operator!=(const const_iterator& other) const { return gaps_ != other.gaps_; }
+
+  private:
+    const uint8_t* gaps_ = nullptr;
+    uint64_t prime_ = 0;
+  };
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  /// Memory usage in bytes
+  std::size_t bytes() const { return gaps_.size() + blocks_.size() * sizeof(Block); }
+  uint64_t back() const { return last_; }
+
+  const_iterator begin() const
+  {
+    if (empty())
+      return end();
+    return const_iterator(gaps_.data(), encode(blocks_[0].prime));
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(gaps_.data() + gaps_.size(), 0);
+  }
+
+  /// Iterator to the i-th prime, i <= size()
+  const_iterator at(std::size_t i) const
+  {
+    if (i >= size_)
+      return end();
+
+    const Block& block = blocks_[i / block_size];
+    const_iterator it(&gaps_[block.offset], encode(block.prime));
+
+    for (std::size_t j = i % block_size; j > 0; j--)
+      ++it;
+
+    return it;
+  }
+
+  /// Get the i-th prime, i < size()
+  uint64_t operator[](std::size_t i) const
+  {
+    return *at(i);
+  }
+
+  void clear()
+  {
+    gaps_.clear();
+    blocks_.clear();
+    size_ = 0;
+    last_ = 0;
+  }
+
+  /// Append a prime, the primes must be pushed in increasing
+  /// order. The gaps between consecutive primes must be even
+  /// (except after 2).
+  ///
+  void push_back(uint64_t prime)
+  {
+    if (!empty())
+    {
+      check_gap(prime);
+      // Remove the sentinel
+      gaps_.pop_back();
+      uint64_t gap = (prime - encode(last_)) / 2;
+
+      while (gap >= 128)
+      {
+        gaps_.push_back((uint8_t) (gap | 128));
+        gap >>= 7;
+      }
+
+      gaps_.push_back((uint8_t) gap);
+    }
+
+    if (size_ % block_size == 0)
+      blocks_.push_back(Block{prime, gaps_.size()});
+
+    // Sentinel gap of 0, allows to increment
+    // an iterator to end() without branches.
+    gaps_.push_back(0);
+    last_ = prime;
+    size_++;
+  }
+
+private:
+  struct Block
+  {
+    uint64_t prime;
+    std::size_t offset;
+  };
+
+  /// gap / 2 of all primes in varint encoding
+  std::vector<uint8_t> gaps_;
+  std::vector<Block> blocks_;
+  std::size_t size_ = 0;
+  uint64_t last_ = 0;
+
+  void check_gap(uint64_t prime) const
+  {
+    if (prime <= last_ ||
+        ((prime - last_) % 2 != 0 && last_ != 2))
+      throw primesieve_error("compressed_primes: primes must be pushed in increasing order");
+  }
+
+  /// 2 is stored as 1, hence all gaps are even
+  static uint64_t encode(uint64_t prime)
+  {
+    return prime - (prime == 2);
+  }
+
+  /// Decode the gap to the next prime and advance gaps
+  static uint64_t next_gap(const uint8_t*& gaps)
+  {
+    uint64_t gap = *gaps++;
+
+    if (gap >= 128)
+      gap = next_gap_varint(gaps, gap);
+
+    return gap * 2;
+  }
+
+  /// Multi-byte gaps are very rare (halved gaps >= 128)
+  static uint64_t next_gap_varint(const uint8_t*& gaps, uint64_t gap)
+  {
+    gap &= 127;
+
+    for (int shift = 7; true; shift += 7)
+    {
+      uint64_t byte = *gaps++;
+      gap |= (byte & 127) << shift;
+      if (byte < 128)
+        return gap;
+    }
+  }
+};
+
+/// Append the primes inside [start, stop] to the
+/// compressed primes container.
+///
+inline void store_primes(uint64_t start,
+                         uint64_t stop,
+                         compressed_primes& primes)
+{
+  if (start > 0)
+    start--;
+  if (~stop == 0)
+    stop--;
+
+  if (start < stop)
+  {
+    uint64_t buffer[1024];
+    primesieve::iterator it(start, stop);
+    std::size_t n;
+
+    do
+    {
+      n = it.fill_primes(buffer, 1024, stop);
+      for (std::size_t i = 0; i < n; i++)
+        primes.push_back(buffer[i]);
+    }
+    while (n == 1024);
+  }
+}
+
+} // namespace
+
+#endif
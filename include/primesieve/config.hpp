@@ -44,11 +44,44 @@ constexpr uint64_t SIEVE_BYTES = L1D_CACHE_BYTES * 8;
 ///
 constexpr uint64_t BUCKET_BYTES = 8 << 10;
 
+/// EratBig::crossOff() prefetches the sieve array byte of the
+/// sieving prime that is processed ERATBIG_PREFETCH_DISTANCE
+/// loop iterations later (2 sieving primes per iteration).
+/// The ideal value depends on the memory latency, it has
+/// been determined experimentally by sieving near 10^19.
+/// Set ERATBIG_PREFETCH_DISTANCE = 0 to disable prefetching.
+///
+constexpr uint64_t ERATBIG_PREFETCH_DISTANCE = 32;
+
+/// Use the AVX512 (gather/scatter + conflict detection) version
+/// of EratBig::crossOff() if the CPU supports AVX512 CD.
+/// Disabled by default because moving the sieving primes into
+/// their next buckets is inherently scalar and gather/scatter
+/// are slow, on Intel Sapphire Rapids the AVX512 version is 5%
+/// to 20% slower near 10^19. Use bench/eratbig.cpp to compare
+/// both versions on your CPU. This default can be overridden
+/// at runtime using the PRIMESIEVE_ERATBIG_AVX512=0|1
+/// environment variable.
+///
+constexpr bool ERATBIG_AVX512 = false;
+
 /// The MemoryPool allocates at most MAX_ALLOC_BYTES of new
 /// memory when it runs out of buckets.
 ///
 constexpr uint64_t MAX_ALLOC_BYTES = 16 << 20;
 
+/// Pre-sieving removes the multiples of small primes from the
+/// sieve array by ANDing precomputed buffers. Tier 1 removes the
+/// multiples of the primes < 100 (210 KiB of buffers), tier 2
+/// additionally removes the multiples of the primes <= 167
+/// (117 KiB of buffers) which saves EratSmall 14 sieving primes.
+/// Tier 2 is only used for large sieving distances (same as
+/// tier 1) and if all pre-sieve buffers fit into half of the
+/// CPU's L2 cache.
+/// Set PRESIEVE_MAX_TIER = 1 to disable tier 2.
+///
+constexpr int PRESIEVE_MAX_TIER = 2;
+
 /// iterator::prev_prime() caches at least MIN_CACHE_ITERATOR
 /// bytes of primes. Larger is usually faster but also
 /// requires more memory.
@@ -66,6 +99,37 @@ constexpr uint64_t MAX_CACHE_ITERATOR = 1 << 30;
 ///
 constexpr uint64_t MIN_THREAD_DISTANCE = (uint64_t) 1e7;
 
+/// count_primes_mod() allocates one counter per residue
+/// class in each thread. Hence the modulus is limited to
+/// MAX_MODULUS (8 MiB of counters per thread).
+///
+constexpr uint64_t MAX_MODULUS = 1 << 20;
+
+/// count_primes_batch() generates the sieving primes up to
+/// sqrt(max(stop)) only once and shares them among all
+/// intervals and threads. The shared sieving primes are
+/// limited to MAX_SHARED_SIEVING_PRIME (about 60 MiB),
+/// intervals with sqrt(stop) > MAX_SHARED_SIEVING_PRIME
+/// generate their sieving primes on the fly.
+///
+constexpr uint64_t MAX_SHARED_SIEVING_PRIME = 1 << 28;
+
+/// parallel_sieve_bitmap() with ordered delivery copies the
+/// segments of a thread's chunk into a buffer until all
+/// preceding chunks have been delivered. Hence the chunks are
+/// limited to MAX_ORDERED_BITMAP_BYTES of sieve array (about
+/// 2 * 10^9 numbers) per thread.
+///
+constexpr uint64_t MAX_ORDERED_BITMAP_BYTES = 64 << 20;
+
+/// Largest supported difference between the last and the
+/// first prime of a user-defined prime constellation. The
+/// constellations that start in a segment but end in the
+/// next segment are found using a buffer of about
+/// MAX_CONSTELLATION_WIDTH / 30 sieve bytes.
+///
+constexpr uint64_t MAX_CONSTELLATION_WIDTH = 1 << 16;
+
 /// Sieving primes <= (L1D_CACHE_BYTES * FACTOR_ERATSMALL)
 /// are processed in EratSmall. The ideal value for
 /// FACTOR_ERATSMALL has been determined experimentally by
@@ -74,6 +138,15 @@ constexpr uint64_t MIN_THREAD_DISTANCE = (uint64_t) 1e7;
 ///
 constexpr double FACTOR_ERATSMALL = 0.2;
 
+/// Sieving primes <= MAX_PATTERN_PRIME are processed in
+/// EratSmall using precomputed bit patterns which are ANDed
+/// into the sieve array using vector instructions. The ideal
+/// value depends on the vector width of the CPU and has been
+/// determined experimentally using bench/eratsmall.cpp.
+/// Set MAX_PATTERN_PRIME = 0 to disable pattern sieving.
+///
+constexpr uint64_t MAX_PATTERN_PRIME = 350;
+
 /// Sieving primes > (sieveSize in bytes * FACTOR_ERATSMALL)
 /// and <= (sieveSize in bytes * FACTOR_ERATMEDIUM)
 /// are processed in EratMedium.
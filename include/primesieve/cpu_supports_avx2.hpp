@@ -0,0 +1,23 @@
+///
+/// @file  cpu_supports_avx2.hpp
+/// @brief Detect if the x86 CPU supports AVX2.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CPU_SUPPORTS_AVX2_HPP
+#define CPU_SUPPORTS_AVX2_HPP
+
+#include "cpuid.hpp"
+
+namespace {
+
+/// Initialized at startup
+const bool cpu_supports_avx2 = primesieve::has_cpuid_avx2();
+
+} // namespace
+
+#endif
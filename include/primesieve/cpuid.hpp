@@ -0,0 +1,40 @@
+///
+/// @file  cpuid.hpp
+/// @brief Runtime detection of x86 CPU features using CPUID.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CPUID_HPP
+#define CPUID_HPP
+
+#if defined(__i386__) || \
+    defined(__x86_64__) || \
+    defined(_M_IX86) || \
+    defined(_M_X64) || \
+    defined(_M_AMD64)
+  #if defined(__GNUC__) || \
+      defined(__clang__) || \
+      defined(_MSC_VER)
+    #define PRIMESIEVE_X86_CPUID
+  #endif
+#endif
+
+#if defined(PRIMESIEVE_X86_CPUID)
+
+namespace primesieve {
+
+bool has_cpuid_avx2();
+bool has_cpuid_avx512_bw();
+bool has_cpuid_avx512_cd();
+bool has_cpuid_avx512_vpopcnt();
+bool has_cpuid_avx512_vbmi2();
+
+} // namespace
+
+#endif
+
+#endif
@@ -32,7 +32,10 @@ extern "C" {
 
 /**
  * C prime iterator, please refer to @link iterator.h iterator.h
- * @endlink for more information.
+ * @endlink for more information. The layout of this struct is part
+ * of the ABI as the inline functions below access its members:
+ * primes[0, last_idx] is the internal buffer of primes and
+ * primes[i] is the last prime returned.
  */
 typedef struct
 {
@@ -64,6 +67,19 @@ void primesieve_free_iterator(primesieve_iterator* it);
  */
 void primesieve_skipto(primesieve_iterator* it, uint64_t start, uint64_t stop_hint);
 
+/**
+ * Store the next primes <= stop into the caller's buffer
+ * (without reallocation) and return the number of primes stored,
+ * at most capacity. The iterator is the resumable cursor: the next
+ * call to primesieve_fill_primes() (or primesieve_next_prime())
+ * continues with the first prime that has not been stored. Hence
+ * fewer than capacity primes are stored only if the next
+ * prime > stop or if an error occurred (it->is_error = 1).
+ * @param buffer  Array of at least capacity elements of type.
+ * @param type    The type of the primes to store, e.g. UINT64_PRIMES.
+ */
+size_t primesieve_fill_primes(primesieve_iterator* it, void* buffer, size_t capacity, uint64_t stop, int type);
+
 /** Internal use */
 void primesieve_generate_next_primes(primesieve_iterator*);
 
@@ -96,6 +112,54 @@ static inline uint64_t primesieve_prev_prime(primesieve_iterator* it)
   return it->primes[it->i];
 }
 
+/**
+ * Get the next block of primes, i.e. the primes of the iterator's
+ * internal buffer that follow the last prime returned. The block is
+ * in increasing order and its size is stored in *size (>= 1). The
+ * iterator is moved to the last prime of the block, hence the next
+ * call to primesieve_next_primes() (or primesieve_next_prime())
+ * continues after it. The returned pointer is valid until the
+ * iterator is modified. The block may contain primes > stop_hint,
+ * it is {UINT64_MAX} if the next prime > 2^64 or if an error
+ * occurred (PRIMESIEVE_ERROR).
+ */
+static inline const uint64_t* primesieve_next_primes(primesieve_iterator* it, size_t* size)
+{
+  size_t first = it->i + 1;
+  if (it->i == it->last_idx)
+  {
+    primesieve_generate_next_primes(it);
+    first = 0;
+  }
+  *size = it->last_idx - first + 1;
+  it->i = it->last_idx;
+  return &it->primes[first];
+}
+
+/**
+ * Get the previous block of primes, i.e. the primes of the
+ * iterator's internal buffer that precede the last prime returned.
+ * The block is in increasing order (iterate it backwards) and its
+ * size is stored in *size (>= 1). The iterator is moved to the
+ * first prime of the block, hence the next call to
+ * primesieve_prev_primes() (or primesieve_prev_prime()) continues
+ * before it. The returned pointer is valid until the iterator is
+ * modified. Once there are no more previous primes the first
+ * element of the block is 0. If an error occurred the block is
+ * {PRIMESIEVE_ERROR}.
+ */
+static inline const uint64_t* primesieve_prev_primes(primesieve_iterator* it, size_t* size)
+{
+  if (it->i == 0)
+  {
+    primesieve_generate_prev_primes(it);
+    it->i++;
+  }
+  *size = it->i;
+  it->i = 0;
+  return &it->primes[0];
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -13,6 +13,7 @@
 #define PRIMESIEVE_ITERATOR_HPP
 
 #include <stdint.h>
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 #include <memory>
@@ -83,6 +84,101 @@ public:
     return primes_[i_];
   }
 
+  /// Get the next block of primes, i.e. the primes of the
+  /// iterator's internal buffer that follow the last prime
+  /// returned. The block is in increasing order and its
+  /// size is stored in *size (>= 1). The iterator is moved to
+  /// the last prime of the block, hence the next call to
+  /// next_primes() (or next_prime()) continues after it.
+  /// The returned pointer is valid until the iterator is
+  /// modified. The block may contain primes > stop_hint, it
+  /// is {UINT64_MAX} if the next prime > 2^64.
+  ///
+  const uint64_t* next_primes(std::size_t* size)
+  {
+    std::size_t first = i_ + 1;
+    if (i_ == last_idx_)
+    {
+      generate_next_primes();
+      first = 0;
+    }
+    *size = last_idx_ - first + 1;
+    i_ = last_idx_;
+    return &primes_[first];
+  }
+
+  /// Get the previous block of primes, i.e. the primes of the
+  /// iterator's internal buffer that precede the last prime
+  /// returned. The block is in increasing order (iterate it
+  /// backwards) and its size is stored in *size (>= 1).
+  /// The iterator is moved to the first prime of the block,
+  /// hence the next call to prev_primes() (or prev_prime())
+  /// continues before it. The returned pointer is valid
+  /// until the iterator is modified. Once there are no more
+  /// previous primes the first element of the block is 0.
+  ///
+  const uint64_t* prev_primes(std::size_t* size)
+  {
+    if (i_ == 0)
+    {
+      generate_prev_primes();
+      i_++;
+    }
+    *size = i_;
+    i_ = 0;
+    return &primes_[0];
+  }
+
+  /// Store the next primes <= stop into the caller's buffer
+  /// (without reallocation) and return the number of primes
+  /// stored, at most capacity. The iterator is the resumable
+  /// cursor: the next call to fill_primes() (or next_prime())
+  /// continues with the first prime that has not been stored.
+  /// Hence fewer than capacity primes are stored only if the
+  /// next prime > stop.
+  ///
+  template <typename T>
+  std::size_t fill_primes(T* buffer,
+                          std::size_t capacity,
+                          uint64_t stop = get_max_stop())
+  {
+    // UINT64_MAX is reserved as error code
+    if (~stop == 0)
+      stop--;
+
+    std::size_t n = 0;
+
+    while (n < capacity)
+    {
+      if (i_ == last_idx_)
+      {
+        if (!generate_next_primes(stop))
+          break;
+        buffer[n++] = (T) primes_[0];
+        continue;
+      }
+
+      std::size_t j = i_ + 1;
+      std::size_t end = std::min(last_idx_, i_ + (capacity - n));
+
+      if (primes_[end] <= stop)
+      {
+        for (; j <= end; j++)
+          buffer[n++] = (T) primes_[j];
+        i_ = end;
+      }
+      else
+      {
+        for (; primes_[j] <= stop; j++)
+          buffer[n++] = (T) primes_[j];
+        i_ = j - 1;
+        break;
+      }
+    }
+
+    return n;
+  }
+
 private:
   std::size_t i_;
   std::size_t last_idx_;
@@ -94,6 +190,7 @@ private:
   std::unique_ptr<PrimeGenerator> primeGenerator_;
   void generate_next_primes();
   void generate_prev_primes();
+  bool generate_next_primes(uint64_t stop);
 };
 
 } // namespace
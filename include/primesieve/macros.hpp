@@ -22,6 +22,10 @@
   #define __has_cpp_attribute(x) 0
 #endif
 
+#ifndef __has_include
+  #define __has_include(x) 0
+#endif
+
 /// Some functions in primesieve use a large number of variables
 /// at the same time. If such functions are inlined then
 /// performance drops because not all variables fit into registers
@@ -55,6 +59,15 @@
   #define FALLTHROUGH
 #endif
 
+/// Prefetch the cache line containing addr for writing.
+/// Prefetching never faults, addr may be invalid.
+#if defined(__GNUC__) || \
+    __has_builtin(__builtin_prefetch)
+  #define PREFETCH_WRITE(addr) __builtin_prefetch(addr, 1, 3)
+#else
+  #define PREFETCH_WRITE(addr)
+#endif
+
 #if defined(__GNUC__) || \
     __has_builtin(__builtin_unreachable)
   #define UNREACHABLE __builtin_unreachable()
@@ -27,7 +27,7 @@ class malloc_vector
 public:
   malloc_vector()
   {
-    resize(16);
+    reserve(16);
   }
 
   malloc_vector(std::size_t n)
@@ -45,26 +45,21 @@ public:
   {
     array_[size_++] = val;
     if (size_ >= capacity_)
-      resize(size_ * 2);
+      reserve(size_ * 2);
   }
 
   void reserve(std::size_t n)
   {
     if (n > capacity_)
-      resize(n);
+      reallocate(n);
   }
 
+  /// New elements are not initialized.
+  /// push_back() requires capacity_ > size_.
   void resize(std::size_t n)
   {
-    n = std::max(n, (std::size_t) 16);
-    T* new_array = (T*) realloc((void*) array_, n * sizeof(T));
-
-    if (!new_array)
-      throw std::bad_alloc();
-
-    array_ = new_array;
-    capacity_ = n;
-    size_ = std::min(size_, capacity_);
+    reserve(n + 1);
+    size_ = n;
   }
 
   T& operator[] (T n)
@@ -87,6 +82,20 @@ public:
     is_free_ = false;
   }
 
+private:
+  void reallocate(std::size_t n)
+  {
+    n = std::max(n, (std::size_t) 16);
+    T* new_array = (T*) realloc((void*) array_, n * sizeof(T));
+
+    if (!new_array)
+      throw std::bad_alloc();
+
+    array_ = new_array;
+    capacity_ = n;
+    size_ = std::min(size_, capacity_);
+  }
+
 public:
   using value_type = T;
 
@@ -0,0 +1,78 @@
+///
+/// @file   tune.hpp
+/// @brief  Sieve size and EratSmall/EratMedium thresholds that
+///         have been determined by benchmarking on the current
+///         machine using primesieve::tune(). The tuned settings
+///         are stored in a tune file and loaded the first time
+///         they are needed.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef TUNE_HPP
+#define TUNE_HPP
+
+#include "config.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace primesieve {
+
+struct TuneSettings
+{
+  /// Sieve size in KiB, 0 if not tuned
+  int sieveSize = 0;
+  /// Runtime replacement of config::FACTOR_ERATSMALL
+  double factorEratSmall = config::FACTOR_ERATSMALL;
+  /// Runtime replacement of config::FACTOR_ERATMEDIUM
+  double factorEratMedium = config::FACTOR_ERATMEDIUM;
+};
+
+/// The benchmarks run by tune(): each candidate setting is
+/// used to count the primes inside [start, start + dist] for
+/// all intervals.
+///
+struct TuneCandidates
+{
+  /// { start, dist } pairs
+  std::vector<std::pair<uint64_t, uint64_t>> intervals;
+  /// Sieve sizes in KiB
+  std::vector<int> sieveSizes;
+  std::vector<double> factorsEratSmall;
+  std::vector<double> factorsEratMedium;
+};
+
+/// Candidates used by primesieve::tune()
+TuneCandidates getTuneCandidates();
+
+/// Find the fastest of the candidate settings, save them
+/// to the tune file and use them from now on.
+///
+TuneSettings tune(const TuneCandidates& candidates);
+
+/// Get a copy of the tuned settings for the current CPU,
+/// on first call these are loaded from the tune file.
+/// Thread-safe, tune() may run concurrently.
+///
+TuneSettings getTuneSettings();
+
+/// Replace the tuned settings of the current process
+/// (without updating the tune file). Thread-safe.
+///
+void setTuneSettings(const TuneSettings& settings);
+
+/// The tune file is $PRIMESIEVE_TUNE_FILE if that environment
+/// variable is set, else .primesieve_tune in the user's home
+/// directory. Returns an empty string if there is no tune file.
+///
+std::string getTuneFile();
+
+} // namespace
+
+#endif
@@ -0,0 +1,255 @@
+///
+/// @file   Constellations.cpp
+/// @brief  Count and print user-defined prime constellations.
+///
+///         A prime constellation { 0, d1, d2, ... } is found at
+///         p if p, p + d1, p + d2, ... are all primes. In the
+///         sieve array each number p + dj is located in the
+///         sieve byte (byte of p) + byte at a fixed bit, for
+///         each of the 8 possible bits of p. Hence we compile
+///         the pattern into a list of (byte, bit) terms for each
+///         bit and find the constellations of 8 sieve bytes at
+///         once by ANDing the shifted 64-bit sieve words of all
+///         terms. This also works for constellations that span
+///         many sieve bytes. Constellations that extend into the
+///         next segment are found by keeping the last few sieve
+///         bytes of each segment (tail_) until the next segment
+///         has been sieved.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/Constellations.hpp>
+#include <primesieve/forward.hpp>
+#include <primesieve/intrinsics.hpp>
+#include <primesieve/littleendian_cast.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace primesieve {
+
+void Constellations::init(const std::vector<uint64_t>& pattern,
+                          uint64_t maxFirstPrime,
+                          bool print)
+{
+  assert(!pattern.empty());
+  assert(pattern[0] == 0);
+
+  pattern_ = pattern;
+  maxFirstPrime_ = maxFirstPrime;
+  print_ = print;
+  count_ = 0;
+  maxByte_ = 0;
+  first_.clear();
+  terms_.clear();
+  tail_.clear();
+
+  for (uint64_t i = 0; i < 8; i++)
+  {
+    bool isAdmissible = true;
+    std::size_t begin = terms_.size();
+
+    for (std::size_t j = 1; j < pattern.size(); j++)
+    {
+      uint64_t n = bitValues[i] + pattern[j];
+      uint64_t rem = n % 30;
+
+      // p + dj is divisible by 2, 3 or 5
+      if (rem % 2 == 0 ||
+          rem % 3 == 0 ||
+          rem % 5 == 0)
+      {
+        isAdmissible = false;
+        break;
+      }
+
+      // The bit values are 7, 11, 13, ..., 29, 31
+      uint64_t bitValue = (rem == 1) ? 31 : rem;
+      uint64_t bit = std::find(bitValues.begin(), bitValues.begin() + 8, bitValue) - bitValues.begin();
+      uint64_t byte = (n - bitValue) / 30;
+      uint64_t rshift = (bit > i) ? bit - i : 0;
+      uint64_t lshift = (bit < i) ? i - bit : 0;
+      terms_.push_back(Term{byte, rshift, lshift});
+    }
+
+    if (!isAdmissible)
+    {
+      terms_.resize(begin);
+      continue;
+    }
+
+    // If the terms of bit i are identical to the terms of
+    // a previous bit we only need to extend its mask.
+    uint64_t mask = 0x0101010101010101ull << i;
+    auto iter = std::find_if(first_.begin(), first_.end(), [&](const First& first)
+    {
+      return first.end - first.begin == terms_.size() - begin &&
+             std::equal(terms_.begin() + first.begin,
+                        terms_.begin() + first.end,
+                        terms_.begin() + begin);
+    });
+
+    for (std::size_t j = begin; j < terms_.size(); j++)
+      maxByte_ = std::max(maxByte_, terms_[j].byte);
+
+    if (iter != first_.end())
+    {
+      iter->mask |= mask;
+      terms_.resize(begin);
+    }
+    else
+      first_.push_back(First{mask, begin, terms_.size()});
+  }
+}
+
+/// Find the constellations whose first prime is located in
+/// the sieve bytes sieve[0, bytes[. The sieve array must be
+/// valid (readable) up to bytes rounded up to 8 + maxByte_.
+///
+/// We process blocks of sieve words term by term, for each
+/// term the inner loop uses the same shifts for all words
+/// and the compiler can vectorize it.
+///
+void Constellations::process(const uint8_t* sieve,
+                             uint64_t bytes,
+                             uint64_t low)
+{
+  uint64_t blockWords = block_.size();
+  uint64_t blockBytes = blockWords * 8;
+  uint64_t* bits = block_.data();
+  uint64_t* acc = acc_.data();
+
+  for (uint64_t i = 0; i < bytes; i += blockBytes)
+  {
+    const uint8_t* s = &sieve[i];
+    uint64_t words = std::min(blockWords, ceilDiv(bytes - i, 8));
+    std::fill_n(bits, words, 0);
+
+    for (const First& first : first_)
+    {
+      uint64_t mask = first.mask;
+      for (uint64_t j = 0; j < words; j++)
+        acc[j] = littleendian_cast<uint64_t>(&s[j * 8]) & mask;
+
+      // Move the bit of p + pattern[k] to the bit of p
+      for (std::size_t k = first.begin; k < first.end; k++)
+      {
+        const uint8_t* t = &s[terms_[k].byte];
+        uint64_t rshift = terms_[k].rshift;
+        uint64_t lshift = terms_[k].lshift;
+        for (uint64_t j = 0; j < words; j++)
+          acc[j] &= (littleendian_cast<uint64_t>(&t[j * 8]) >> rshift) << lshift;
+      }
+
+      for (uint64_t j = 0; j < words; j++)
+        bits[j] |= acc[j];
+    }
+
+    // Remove the bytes >= bytes
+    uint64_t rem = (bytes - i) % 8;
+    if (words * 8 > bytes - i)
+      bits[words - 1] &= (1ull << (rem * 8)) - 1;
+
+    // Fast path, all first primes of the block are
+    // <= maxFirstPrime_. The largest number of the
+    // block is low + 30 * (i + words * 8 - 1) + 31.
+    uint64_t blockLow = low + i * 30;
+    uint64_t maxOffset = (words * 8 - 1) * 30 + 31;
+
+    if (!print_ &&
+        maxFirstPrime_ >= blockLow &&
+        maxFirstPrime_ - blockLow >= maxOffset)
+      count_ += popcount(bits, words);
+    else
+    {
+      for (uint64_t j = 0; j < words; j++)
+        if (bits[j])
+          found(bits[j], blockLow + j * 8 * 30);
+    }
+  }
+}
+
+void Constellations::found(uint64_t bits, uint64_t low)
+{
+  for (; bits != 0; bits &= bits - 1)
+  {
+    uint64_t prime = low + bitValues[ctz64(bits)];
+    if (prime > maxFirstPrime_)
+      break;
+
+    if (!print_)
+      count_++;
+    else
+    {
+      out_ << "(";
+      for (std::size_t j = 0; j < pattern_.size(); j++)
+        out_ << prime + pattern_[j] << ((j + 1 < pattern_.size()) ? ", " : ")\n");
+    }
+  }
+}
+
+void Constellations::addSegment(const uint8_t* sieve,
+                                uint64_t bytes,
+                                uint64_t low)
+{
+  // Find the constellations that start in the
+  // previous segment and extend into this segment.
+  if (!tail_.empty())
+  {
+    uint64_t size = tail_.size();
+    uint64_t n = std::min(bytes, maxByte_ + 8);
+    assert(tailLow_ + size * 30 == low);
+    buffer_.assign(tail_.begin(), tail_.end());
+    buffer_.insert(buffer_.end(), sieve, sieve + n);
+    buffer_.resize(size + maxByte_ + 16, 0);
+    process(buffer_.data(), size, tailLow_);
+    tail_.clear();
+  }
+
+  // Find the constellations that fit into this segment,
+  // the remaining sieve bytes are processed together
+  // with the next segment.
+  uint64_t n = 0;
+  if (bytes >= maxByte_)
+    n = (bytes - maxByte_) / 8 * 8;
+
+  process(sieve, n, low);
+  tail_.assign(sieve + n, sieve + bytes);
+  tailLow_ = low + n * 30;
+  flush();
+}
+
+/// Called after the last segment has been sieved
+void Constellations::finish()
+{
+  if (!tail_.empty())
+  {
+    uint64_t size = tail_.size();
+    buffer_.assign(tail_.begin(), tail_.end());
+    buffer_.resize(size + maxByte_ + 16, 0);
+    process(buffer_.data(), size, tailLow_);
+    tail_.clear();
+  }
+
+  flush();
+}
+
+void Constellations::flush()
+{
+  if (print_)
+  {
+    std::cout << out_.str();
+    out_.str("");
+  }
+}
+
+} // namespace
@@ -15,8 +15,10 @@
 #include <primesieve/EratSmall.hpp>
 #include <primesieve/EratMedium.hpp>
 #include <primesieve/EratBig.hpp>
+#include <primesieve/forward.hpp>
 #include <primesieve/PreSieve.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/tune.hpp>
 
 #include <stdint.h>
 #include <array>
@@ -59,12 +61,14 @@ Erat::Erat(uint64_t start, uint64_t stop) :
 /// @stop:      Sieve primes <= stop
 /// @sieveSize: Sieve size in KiB
 /// @preSieve:  Pre-sieve small primes
+/// @settings:  EratSmall/EratMedium thresholds
 ///
 void Erat::init(uint64_t start,
                 uint64_t stop,
                 uint64_t sieveSize,
                 PreSieve& preSieve,
-                MemoryPool& memoryPool)
+                MemoryPool& memoryPool,
+                const TuneSettings& settings)
 {
   if (start > stop)
     return;
@@ -74,6 +78,7 @@ void Erat::init(uint64_t start,
   stop_ = stop;
   memoryPool_ = &memoryPool;
   preSieve_ = &preSieve;
+  tuneSettings_ = settings;
   preSieve_->init(start, stop);
   maxPreSieve_ = preSieve_->getMaxPrime();
 
@@ -102,15 +107,43 @@ void Erat::initAlgorithms()
   uint64_t sqrtStop = isqrt(stop_);
   uint64_t l1CacheSize = getL1CacheSize();
 
-  maxEratSmall_ = (uint64_t) (l1CacheSize * config::FACTOR_ERATSMALL);
-  maxEratMedium_ = (uint64_t) (sieveSize_ * config::FACTOR_ERATMEDIUM);
+  // Defaults to config::FACTOR_ERATSMALL and
+  // config::FACTOR_ERATMEDIUM if primesieve::tune()
+  // has not been run on this machine.
+  maxEratSmall_ = (uint64_t) (l1CacheSize * tuneSettings_.factorEratSmall);
+  maxEratMedium_ = (uint64_t) (sieveSize_ * tuneSettings_.factorEratMedium);
+
+  // If the sieve array does not fit into the L2 cache,
+  // EratMedium processes it in tiles of the default
+  // sieve size (8 * L1 cache size). If we only count
+  // primes, then all sieving steps are fused so that
+  // each tile is completely processed while it is in
+  // the cache, see countSegment(). Smaller (L1 cache
+  // sized) tiles run slower because then EratMedium and
+  // EratBig move their sieving primes too often.
+  uint64_t tileSize = sieveSize_;
+  if (cpuInfo.hasL2Cache() &&
+      sieveSize_ > cpuInfo.l2CacheBytes())
+  {
+    tileSize = floorPow2(std::min(l1CacheSize * 8, sieveSize_));
+    if (isCountOnly_)
+      tileSize_ = tileSize;
+  }
 
   if (sqrtStop > maxPreSieve_)
-    eratSmall_.init(stop_, l1CacheSize, maxEratSmall_);
+    eratSmall_.init(stop_, l1CacheSize, maxEratSmall_, config::MAX_PATTERN_PRIME);
   if (sqrtStop > maxEratSmall_)
-    eratMedium_.init(stop_, maxEratMedium_, memoryPool_);
+    eratMedium_.init(stop_, sieveSize_, tileSize, maxEratMedium_, memoryPool_);
+  // EratMedium uses larger tiles
+  // if the sieve array is very large.
+  if (tileSize_ &&
+      sqrtStop > maxEratSmall_)
+    tileSize_ = eratMedium_.getTileSize();
+
+  // The fused count pipeline uses one EratBig
+  // segment (bucket list) per tile.
   if (sqrtStop > maxEratMedium_)
-    eratBig_.init(stop_, sieveSize_, sqrtStop, memoryPool_);
+    eratBig_.init(stop_, tileSize_ ? tileSize_ : sieveSize_, sqrtStop, memoryPool_);
 
   // If we are sieving just a single segment
   // and the EratBig algorithm is not used, then
@@ -177,6 +210,79 @@ void Erat::sieveSegment()
     sieveLastSegment();
 }
 
+/// Count-only version of sieveSegment() and
+/// PrintPrimes::countPrimes() for sieve arrays that do
+/// not fit into the L2 cache. Instead of pre-sieving,
+/// crossing off and counting the entire segment one after
+/// the other, each tile of the segment is completely
+/// processed (pre-sieve, cross-off, count) while it is
+/// still in the cache. Returns the number of primes inside
+/// the current segment.
+///
+uint64_t Erat::countSegment()
+{
+  bool isLastSegment = (segmentHigh_ >= stop_);
+  uint64_t rem = byteRemainder(stop_);
+
+  if (isLastSegment)
+  {
+    uint64_t dist = (stop_ - rem) - segmentLow_;
+    sieveSize_ = dist / 30 + 1;
+  }
+
+  uint64_t count = 0;
+
+  for (uint64_t tile = 0; tile * tileSize_ < sieveSize_; tile++)
+  {
+    uint64_t tileStart = tile * tileSize_;
+    uint64_t tileEnd = std::min(tileStart + tileSize_, sieveSize_);
+    uint64_t bytes = tileEnd - tileStart;
+    uint8_t* sieve = &sieve_[tileStart];
+
+    preSieve_->preSieve(sieve, bytes, segmentLow_ + tileStart * 30);
+
+    // unset bits < start
+    if (tile == 0 &&
+        segmentLow_ <= start_)
+      sieve_[0] &= unsetSmaller[byteRemainder(start_)];
+
+    if (eratSmall_.hasSievingPrimes())
+      eratSmall_.crossOff(sieve, bytes);
+    if (eratMedium_.hasSievingPrimes())
+      eratMedium_.crossOffTile(sieve_, sieveSize_, tile);
+    if (eratBig_.hasSievingPrimes())
+      eratBig_.crossOff(sieve);
+
+    if (isLastSegment &&
+        tileEnd == sieveSize_)
+    {
+      // unset bits > stop
+      sieve_[sieveSize_ - 1] &= unsetLarger[rem];
+
+      // unset bytes > stop
+      uint64_t padding = (8 - bytes % 8) % 8;
+      std::fill_n(&sieve_[sieveSize_], padding, (uint8_t) 0);
+    }
+
+    count += popcount((const uint64_t*) sieve, ceilDiv(bytes, 8));
+  }
+
+  if (eratMedium_.hasSievingPrimes())
+    eratMedium_.nextSegment();
+
+  if (isLastSegment)
+    segmentLow_ = stop_;
+  else
+  {
+    uint64_t dist = sieveSize_ * 30;
+    segmentLow_ = checkedAdd(segmentLow_, dist);
+    segmentHigh_ = checkedAdd(segmentHigh_, dist);
+    segmentHigh_ = std::min(segmentHigh_, stop_);
+  }
+
+  return count;
+}
+
 void Erat::sieveLastSegment()
 {
   uint64_t rem = byteRemainder(stop_);
@@ -197,7 +303,7 @@ void Erat::sieveLastSegment()
   segmentLow_ = stop_;
 }
 
-/// Pre-sieve multiples of small primes < 100
+/// Pre-sieve multiples of small primes <= 167
 /// to speed up the sieve of Eratosthenes
 ///
 void Erat::preSieve()
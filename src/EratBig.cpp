@@ -27,6 +27,8 @@
 #include <primesieve/EratBig.hpp>
 #include <primesieve/bits.hpp>
 #include <primesieve/Bucket.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/macros.hpp>
 #include <primesieve/MemoryPool.hpp>
 #include <primesieve/pmath.hpp>
 
@@ -34,8 +36,26 @@
 #include <cassert>
 #include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 
+#if defined(__AVX512F__) && \
+    defined(__AVX512CD__) && \
+    __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX512_CD
+
+#elif defined(ENABLE_MULTIARCH_AVX512_CD) && \
+      __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #include <primesieve/cpu_supports_avx512_cd.hpp>
+#endif
+
+using primesieve::Bucket;
+using primesieve::MemoryPool;
+using primesieve::SievingPrime;
+
 namespace {
 
 /// The WheelElement data structure is used to skip multiples
@@ -118,6 +138,149 @@ const std::array<WheelElement, 8*48> wheel210 =
   { BIT6, 2, 0, 377 }, { BIT7, 6, 1, 378 }, { BIT0, 4, 0, 379 }, { BIT1, 2, 0, 380 }, { BIT2, 4, 0, 381 }, { BIT3, 2, 0, 382 }, { BIT4, 10, 0, 383 }, { BIT6, 2, 0, 336 }
 }};
 
+
+#if defined(ENABLE_AVX512_CD) || \
+    defined(ENABLE_MULTIARCH_AVX512_CD)
+
+static_assert(sizeof(SievingPrime) == sizeof(uint64_t),
+              "crossOff_avx512() requires sizeof(SievingPrime) == 8");
+
+/// AVX512 version of EratBig::crossOff(uint8_t*, Bucket*).
+/// Processes 16 sieving primes per loop iteration: the
+/// SievingPrime objects are split into their indexes_ and
+/// sievingPrime_ fields, the wheel210 elements are gathered,
+/// the bits are cleared using gather/scatter of 32-bit words
+/// and the next multiples are computed in vector registers.
+/// If 2 sieving primes of the same iteration clear bits in the
+/// same 32-bit word (detected using vpconflictd) we clear the
+/// bits one at a time. Only moving the sieving primes into
+/// their next buckets is done using scalar code.
+///
+#if defined(ENABLE_MULTIARCH_AVX512_CD)
+  __attribute__ ((target ("avx512f,avx512cd")))
+#endif
+void crossOff_avx512(uint8_t* sieve,
+                     Bucket* bucket,
+                     SievingPrime** buckets,
+                     uint64_t log2SieveSize,
+                     uint64_t moduloSieveSize,
+                     MemoryPool& memoryPool)
+{
+  SievingPrime* prime = bucket->begin();
+  SievingPrime* end = bucket->end();
+  const int* wheel = (const int*) wheel210.data();
+
+  const __m512i evenLanes = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+  const __m512i oddLanes = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+  const __m512i lowLanes = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+  const __m512i highLanes = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+  const __m512i maxMultipleIndex = _mm512_set1_epi32(SievingPrime::MAX_MULTIPLEINDEX);
+  const __m512i moduloSieveSizeVec = _mm512_set1_epi32((int) moduloSieveSize);
+  const __m512i lowByte = _mm512_set1_epi32(0xff);
+  const __m128i log2SieveSizeVec = _mm_cvtsi32_si128((int) log2SieveSize);
+
+  alignas(64) uint32_t segments[16];
+  alignas(64) SievingPrime primes[16];
+
+  for (; prime + 16 <= end; prime += 16)
+  {
+    if (config::ERATBIG_PREFETCH_DISTANCE > 0)
+    {
+      SievingPrime* next = std::min(prime + config::ERATBIG_PREFETCH_DISTANCE * 2, end - 16);
+      for (int i = 0; i < 16; i++)
+        PREFETCH_WRITE(&sieve[next[i].getMultipleIndex()]);
+    }
+
+    __m512i p0 = _mm512_loadu_si512((const __m512i*) &prime[0]);
+    __m512i p1 = _mm512_loadu_si512((const __m512i*) &prime[8]);
+    __m512i indexes = _mm512_permutex2var_epi32(p0, evenLanes, p1);
+    __m512i sievingPrime = _mm512_permutex2var_epi32(p0, oddLanes, p1);
+    __m512i multipleIndex = _mm512_and_si512(indexes, maxMultipleIndex);
+    __m512i wheelIndex = _mm512_srli_epi32(indexes, 23);
+
+    // WheelElement: { unsetBit, nextMultipleFactor, correct, padding, next }
+    __m512i wheelBytes = _mm512_i32gather_epi32(wheelIndex, (const void*) &wheel[0], 8);
+    __m512i nextWheelIndex = _mm512_i32gather_epi32(wheelIndex, (const void*) &wheel[1], 8);
+
+    // Clear the bits of the current multiples
+    __m512i wordIndex = _mm512_srli_epi32(multipleIndex, 2);
+    __m512i shift = _mm512_slli_epi32(_mm512_and_si512(multipleIndex, _mm512_set1_epi32(3)), 3);
+    __m512i bit = _mm512_andnot_si512(wheelBytes, lowByte);
+    __m512i clearMask = _mm512_sllv_epi32(bit, shift);
+    __m512i conflicts = _mm512_conflict_epi32(wordIndex);
+
+    if (_mm512_test_epi32_mask(conflicts, conflicts) == 0)
+    {
+      __m512i words = _mm512_i32gather_epi32(wordIndex, (const void*) sieve, 4);
+      words = _mm512_andnot_si512(clearMask, words);
+      _mm512_i32scatter_epi32((void*) sieve, wordIndex, words, 4);
+    }
+    else
+    {
+      for (int i = 0; i < 16; i++)
+      {
+        uint64_t multipleIndex = prime[i].getMultipleIndex();
+        uint64_t wheelIndex = prime[i].getWheelIndex();
+        sieve[multipleIndex] &= wheel210[wheelIndex].unsetBit;
+      }
+    }
+
+    // Calculate the next multiples
+    __m512i factor = _mm512_and_si512(_mm512_srli_epi32(wheelBytes, 8), lowByte);
+    __m512i correct = _mm512_and_si512(_mm512_srli_epi32(wheelBytes, 16), lowByte);
+    multipleIndex = _mm512_add_epi32(multipleIndex, _mm512_mullo_epi32(factor, sievingPrime));
+    multipleIndex = _mm512_add_epi32(multipleIndex, correct);
+    __m512i segment = _mm512_srl_epi32(multipleIndex, log2SieveSizeVec);
+    multipleIndex = _mm512_and_si512(multipleIndex, moduloSieveSizeVec);
+    indexes = _mm512_or_si512(multipleIndex, _mm512_slli_epi32(nextWheelIndex, 23));
+
+    _mm512_store_si512((__m512i*) segments, segment);
+    _mm512_store_si512((__m512i*) &primes[0], _mm512_permutex2var_epi32(indexes, lowLanes, sievingPrime));
+    _mm512_store_si512((__m512i*) &primes[8], _mm512_permutex2var_epi32(indexes, highLanes, sievingPrime));
+
+    // Move the sieving primes into their next buckets
+    for (int i = 0; i < 16; i++)
+    {
+      uint32_t seg = segments[i];
+      *buckets[seg]++ = primes[i];
+      if_unlikely(Bucket::isFull(buckets[seg]))
+        memoryPool.addBucket(buckets[seg]);
+    }
+  }
+
+  // Process the remaining sieving primes
+  for (; prime < end; prime++)
+  {
+    uint64_t multipleIndex = prime->getMultipleIndex();
+    uint64_t wheelIndex    = prime->getWheelIndex();
+    uint64_t sievingPrime  = prime->getSievingPrime();
+
+    sieve[multipleIndex] &= wheel210[wheelIndex].unsetBit;
+    multipleIndex += wheel210[wheelIndex].nextMultipleFactor * sievingPrime;
+    multipleIndex += wheel210[wheelIndex].correct;
+    wheelIndex = wheel210[wheelIndex].next;
+    uint64_t segment = multipleIndex >> log2SieveSize;
+    multipleIndex &= moduloSieveSize;
+
+    buckets[segment]++->set(sievingPrime, multipleIndex, wheelIndex);
+    if_unlikely(Bucket::isFull(buckets[segment]))
+      memoryPool.addBucket(buckets[segment]);
+  }
+}
+
+#endif
+
+/// Read the PRIMESIEVE_ERATBIG_AVX512 environment variable,
+/// returns config::ERATBIG_AVX512 if it is not set.
+///
+bool getEnvAvx512()
+{
+  const char* env = std::getenv("PRIMESIEVE_ERATBIG_AVX512");
+  if (env && *env)
+    return std::strcmp(env, "0") != 0;
+  return config::ERATBIG_AVX512;
+}
+
 } // namespace
 
 namespace primesieve {
@@ -141,6 +304,8 @@ void EratBig::init(uint64_t stop,
   moduloSieveSize_ = sieveSize - 1;
   memoryPool_ = memoryPool;
 
+  setAvx512(useAvx512());
+
   uint64_t maxSievingPrime = maxPrime_ / 30;
   uint64_t maxNextMultiple = maxSievingPrime * getMaxFactor() + getMaxFactor();
   uint64_t maxMultipleIndex = sieveSize - 1 + maxNextMultiple;
@@ -149,6 +314,32 @@ void EratBig::init(uint64_t stop,
   buckets_.reserve(maxSize);
 }
 
+/// config::ERATBIG_AVX512 can be overridden at runtime
+/// by setting PRIMESIEVE_ERATBIG_AVX512=0 or 1. The
+/// environment variable is read only once, at the first
+/// call of this function.
+///
+bool EratBig::useAvx512()
+{
+  static const bool avx512 = getEnvAvx512();
+  return avx512;
+}
+
+/// Use the AVX512 crossOff() code path
+/// if enable is true and if the CPU supports it.
+///
+void EratBig::setAvx512(bool enable)
+{
+#if defined(ENABLE_AVX512_CD)
+  avx512_ = enable;
+#elif defined(ENABLE_MULTIARCH_AVX512_CD)
+  avx512_ = enable && cpu_supports_avx512_cd;
+#else
+  avx512_ = false;
+  (void) enable;
+#endif
+}
+
 /// Add a new sieving prime
 void EratBig::storeSievingPrime(uint64_t prime,
                                 uint64_t multipleIndex,
@@ -202,7 +393,13 @@ void EratBig::crossOff(uint8_t* sieve)
     // to the current segment.
     while (bucket)
     {
-      crossOff(sieve, bucket);
+#if defined(ENABLE_AVX512_CD) || \
+    defined(ENABLE_MULTIARCH_AVX512_CD)
+      if (avx512_)
+        crossOff_avx512(sieve, bucket, buckets_.data(), log2SieveSize_, moduloSieveSize_, *memoryPool_);
+      else
+#endif
+        crossOff(sieve, bucket);
       Bucket* processed = bucket;
       bucket = bucket->next();
       memoryPool_->freeBucket(processed);
@@ -224,6 +421,14 @@ void EratBig::crossOff(uint8_t* sieve)
 /// we move the sieving prime to the bucket list related to
 /// the previously computed segment.
 ///
+/// Since the sieve array is usually much larger than the CPU's
+/// L1 cache, nearly every sieve[multipleIndex] access is a cache
+/// miss. Hence we prefetch the sieve bytes of the sieving primes
+/// that will be processed a few loop iterations later. The
+/// SievingPrime objects themselves are read sequentially and
+/// the bucket writes are sequential too, the hardware
+/// prefetcher handles these well.
+///
 void EratBig::crossOff(uint8_t* sieve, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
@@ -237,6 +442,13 @@ void EratBig::crossOff(uint8_t* sieve, Bucket* bucket)
   // increase instruction level parallelism.
   for (; prime < last; prime += 2)
   {
+    if (config::ERATBIG_PREFETCH_DISTANCE > 0)
+    {
+      SievingPrime* next = std::min(prime + config::ERATBIG_PREFETCH_DISTANCE * 2, last - 1);
+      PREFETCH_WRITE(&sieve[next[0].getMultipleIndex()]);
+      PREFETCH_WRITE(&sieve[next[1].getMultipleIndex()]);
+    }
+
     uint64_t multipleIndex0 = prime[0].getMultipleIndex();
     uint64_t wheelIndex0    = prime[0].getWheelIndex();
     uint64_t sievingPrime0  = prime[0].getSievingPrime();
@@ -11,6 +11,18 @@
 ///         by up to 30% for sieving primes that have only a few
 ///         multiple occurrences per segment.
 ///
+///         If the sieve array does not fit into the L2 cache it
+///         is processed in tiles of the default sieve size
+///         (8 * L1 cache size). Each tile has
+///         its own 64 bucket lists, after a sieving prime's
+///         multiples inside the current tile have been crossed
+///         off, the sieving prime is moved to the bucket list of
+///         the tile that contains its next multiple. Hence all
+///         medium sieving primes cross off their multiples in the
+///         same hot tile before we move on to the next tile.
+///         Smaller (L1 cache sized) tiles run slower because then
+///         the sieving primes are moved too often.
+///
 /// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -23,31 +35,56 @@
 #include <primesieve/macros.hpp>
 #include <primesieve/MemoryPool.hpp>
 
+#include <primesieve/pmath.hpp>
+
 #include <stdint.h>
+#include <algorithm>
 #include <cassert>
 
-/// This macro sorts the current sieving prime by its
-/// wheelIndex after sieving has finished. When we then
-/// iterate over the sieving primes in the next segment the
-/// 'switch (wheelIndex)' branch will be predicted
-/// correctly by the CPU.
+/// This macro moves the current sieving prime to the bucket
+/// list of the tile that contains its next multiple (or to
+/// the bucket list of the next segment) after sieving the
+/// current tile has finished. The sieving prime is also
+/// sorted by its wheelIndex, when we then iterate over the
+/// sieving primes in the next tile the 'switch (wheelIndex)'
+/// branch will be predicted correctly by the CPU.
 ///
 #define CHECK_FINISHED(wheelIndex) \
-  if_unlikely(p >= sieveEnd) \
+  if_unlikely(p >= tileEnd) \
   { \
-    multipleIndex = (uint64_t) (p - sieveEnd); \
-    if (Bucket::isFull(buckets_[wheelIndex])) \
-      memoryPool.addBucket(buckets_[wheelIndex]); \
-    buckets_[wheelIndex]++->set(sievingPrime, multipleIndex, wheelIndex); \
+    multipleIndex = (uint64_t) (p - sieve); \
+    SievingPrime** list; \
+    if (multipleIndex < sieveSize) \
+      list = &buckets[std::min(multipleIndex >> log2TileSize, maxTile)][wheelIndex]; \
+    else \
+    { \
+      multipleIndex -= sieveSize; \
+      list = &nextBuckets[std::min(multipleIndex >> log2TileSize, maxTile)][wheelIndex]; \
+    } \
+    if (Bucket::isFull(*list)) \
+      memoryPool.addBucket(*list); \
+    (*list)++->set(sievingPrime, multipleIndex, wheelIndex); \
     break; \
   }
 
+namespace {
+
+/// We use at most MAX_TILES tiles per segment, this
+/// limits the number of bucket lists (64 per tile).
+const uint64_t MAX_TILES = 16;
+
+} // namespace
+
 namespace primesieve {
 
 /// @stop:      Upper bound for sieving
+/// @sieveSize: Sieve size in bytes
+/// @tileSize:  Process the sieve array in tiles of tileSize bytes
 /// @maxPrime:  Sieving primes <= maxPrime
 ///
 void EratMedium::init(uint64_t stop,
+                      uint64_t sieveSize,
+                      uint64_t tileSize,
                       uint64_t maxPrime,
                       MemoryPool* memoryPool)
 {
@@ -58,7 +95,17 @@ void EratMedium::init(uint64_t stop,
   stop_ = stop;
   maxPrime_ = maxPrime;
   memoryPool_ = memoryPool;
-  buckets_.fill(nullptr);
+
+  // '>> log2TileSize' requires power of 2 tileSize
+  tileSize = std::max(tileSize, sieveSize / MAX_TILES);
+  tileSize = floorPow2(tileSize);
+  uint64_t tiles = std::max(ceilDiv(sieveSize, tileSize), (uint64_t) 1);
+  log2TileSize_ = ilog2(tileSize);
+
+  std::array<SievingPrime*, 64> empty;
+  empty.fill(nullptr);
+  buckets_.assign(tiles, empty);
+  nextBuckets_.assign(tiles, empty);
 }
 
 /// Add a new sieving prime to EratMedium
@@ -68,20 +115,50 @@ void EratMedium::storeSievingPrime(uint64_t prime,
 {
   assert(prime <= maxPrime_);
   uint64_t sievingPrime = prime / 30;
+  uint64_t tile = multipleIndex >> log2TileSize_;
+  tile = std::min(tile, (uint64_t) buckets_.size() - 1);
+  SievingPrime*& list = buckets_[tile][wheelIndex];
 
-  if (Bucket::isFull(buckets_[wheelIndex]))
-    memoryPool_->addBucket(buckets_[wheelIndex]);
+  if (Bucket::isFull(list))
+    memoryPool_->addBucket(list);
 
   hasSievingPrimes_ = true;
-  buckets_[wheelIndex]++->set(sievingPrime, multipleIndex, wheelIndex);
+  list++->set(sievingPrime, multipleIndex, wheelIndex);
 }
 
 void EratMedium::crossOff(uint8_t* sieve, uint64_t sieveSize)
 {
-  // Make a copy of buckets, then reset it
-  auto buckets = buckets_;
-  buckets_.fill(nullptr);
+  for (uint64_t tile = 0; tile < buckets_.size(); tile++)
+    crossOffTile(sieve, sieveSize, tile);
+
+  nextSegment();
+}
+
+/// Cross off the multiples inside the tile-th tile of the
+/// sieve array. The tiles of a segment must be processed in
+/// ascending order, then nextSegment() must be called.
+///
+void EratMedium::crossOffTile(uint8_t* sieve,
+                              uint64_t sieveSize,
+                              uint64_t tile)
+{
+  if (tile >= buckets_.size())
+    return;
+
+  uint64_t tileSize = 1ull << log2TileSize_;
   uint8_t* sieveEnd = sieve + sieveSize;
+  sieveSize_ = sieveSize;
+
+  // Make a copy of the tile's buckets, then reset them
+  auto buckets = buckets_[tile];
+  buckets_[tile].fill(nullptr);
+
+  // The last tiles may be empty in the last segment,
+  // then all of their sieving primes are
+  // moved to the next segment.
+  uint64_t tileStart = std::min(tile * tileSize, sieveSize);
+  uint64_t tileEnd = std::min(tileStart + tileSize, sieveSize);
+  uint8_t* tileEndPtr = (tile + 1 < buckets_.size()) ? sieve + tileEnd : sieveEnd;
 
   // Iterate over the 64 bucket lists.
   // The 1st list contains sieving primes with wheelIndex = 0.
@@ -98,20 +175,20 @@ void EratMedium::crossOff(uint8_t* sieve, uint64_t sieveSize)
     uint64_t wheelIndex = i;
 
     // Iterate over the current bucket list.
-    // For each bucket cross off the
-    // multiples of its sieving primes.
+    // For each bucket cross off the multiples
+    // of its sieving primes inside the tile.
     while (bucket)
     {
       switch (wheelIndex / 8)
       {
-        case 0: crossOff_7 (sieve, sieveEnd, bucket); break;
-        case 1: crossOff_11(sieve, sieveEnd, bucket); break;
-        case 2: crossOff_13(sieve, sieveEnd, bucket); break;
-        case 3: crossOff_17(sieve, sieveEnd, bucket); break;
-        case 4: crossOff_19(sieve, sieveEnd, bucket); break;
-        case 5: crossOff_23(sieve, sieveEnd, bucket); break;
-        case 6: crossOff_29(sieve, sieveEnd, bucket); break;
-        case 7: crossOff_31(sieve, sieveEnd, bucket); break;
+        case 0: crossOff_7 (sieve, tileEndPtr, bucket); break;
+        case 1: crossOff_11(sieve, tileEndPtr, bucket); break;
+        case 2: crossOff_13(sieve, tileEndPtr, bucket); break;
+        case 3: crossOff_17(sieve, tileEndPtr, bucket); break;
+        case 4: crossOff_19(sieve, tileEndPtr, bucket); break;
+        case 5: crossOff_23(sieve, tileEndPtr, bucket); break;
+        case 6: crossOff_29(sieve, tileEndPtr, bucket); break;
+        case 7: crossOff_31(sieve, tileEndPtr, bucket); break;
         default: UNREACHABLE;
       }
 
@@ -122,13 +199,26 @@ void EratMedium::crossOff(uint8_t* sieve, uint64_t sieveSize)
   }
 }
 
+/// The bucket lists of the next segment
+/// become the current bucket lists.
+///
+void EratMedium::nextSegment()
+{
+  std::swap(buckets_, nextBuckets_);
+}
+
 /// For sieving primes of type n % 30 == 7
-void EratMedium::crossOff_7(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_7(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -160,12 +250,17 @@ void EratMedium::crossOff_7(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 11
-void EratMedium::crossOff_11(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_11(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -198,12 +293,17 @@ void EratMedium::crossOff_11(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 13
-void EratMedium::crossOff_13(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_13(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -236,12 +336,17 @@ void EratMedium::crossOff_13(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 17
-void EratMedium::crossOff_17(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_17(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -274,12 +379,17 @@ void EratMedium::crossOff_17(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 19
-void EratMedium::crossOff_19(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_19(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -312,12 +422,17 @@ void EratMedium::crossOff_19(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 23
-void EratMedium::crossOff_23(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_23(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -349,12 +464,17 @@ void EratMedium::crossOff_23(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 29
-void EratMedium::crossOff_29(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_29(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -386,12 +506,17 @@ void EratMedium::crossOff_29(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
 }
 
 /// For sieving primes of type n % 30 == 1
-void EratMedium::crossOff_31(uint8_t* sieve, uint8_t* sieveEnd, Bucket* bucket)
+void EratMedium::crossOff_31(uint8_t* sieve, uint8_t* tileEnd, Bucket* bucket)
 {
   SievingPrime* prime = bucket->begin();
   SievingPrime* end = bucket->end();
   uint64_t wheelIndex = prime->getWheelIndex();
   MemoryPool& memoryPool = *memoryPool_;
+  auto* buckets = buckets_.data();
+  auto* nextBuckets = nextBuckets_.data();
+  uint64_t sieveSize = sieveSize_;
+  uint64_t log2TileSize = log2TileSize_;
+  uint64_t maxTile = buckets_.size() - 1;
 
   for (; prime != end; prime++)
   {
@@ -9,6 +9,14 @@
 ///         multiples uses as few instructions as possible since there
 ///         are so many multiples.
 ///
+///         For the smallest sieving primes (just above the pre-sieve
+///         limit) each L1 cache block contains thousands of
+///         multiples. For these primes we precompute a periodic bit
+///         pattern (1 period = prime bytes) and AND it into the
+///         sieve array using AVX512 or AVX2 instructions. This
+///         replaces many scattered byte writes by a few streaming
+///         vector ANDs.
+///
 /// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -24,8 +32,33 @@
 #include <stdint.h>
 #include <algorithm>
 #include <cassert>
+#include <initializer_list>
 #include <vector>
 
+#if defined(__AVX512F__) && \
+    defined(__AVX512BW__) && \
+    __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX512_BW
+
+#elif defined(__AVX2__) && \
+      __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX2
+
+#elif (defined(ENABLE_MULTIARCH_AVX512_BW) || \
+       defined(ENABLE_MULTIARCH_AVX2)) && \
+       __has_include(<immintrin.h>)
+  #include <immintrin.h>
+
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    #include <primesieve/cpu_supports_avx512_bw.hpp>
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    #include <primesieve/cpu_supports_avx2.hpp>
+  #endif
+#endif
+
 using std::size_t;
 
 /// Update the current sieving prime's multipleIndex
@@ -39,15 +72,239 @@ using std::size_t;
     break; \
   }
 
+namespace {
+
+/// Up to MAX_GROUP pattern primes are ANDed into the
+/// sieve array at once, the sieve array is only loaded
+/// and stored once per group.
+const int MAX_GROUP = 4;
+
+/// The pattern size is a multiple of the prime >= PATTERN_PADDING
+/// and each pattern is stored with PATTERN_PADDING extra bytes.
+/// This way we can load 4 full vector registers starting at any
+/// position < size and a single subtraction wraps around.
+const uint64_t PATTERN_PADDING = 256;
+
+/// Bit index of the offsets { 7, 11, 13, 17, 19, 23, 29, 31 }
+const uint8_t offsetBitIndex[32] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 0, 0,
+  0, 3, 0, 4, 0, 0, 0, 5, 0, 0, 0, 0, 0, 6, 0, 7
+};
+
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+void andPatterns_avx2(uint8_t* sieve,
+                      uint64_t bytes,
+                      const uint8_t* const* patterns,
+                      uint64_t* pos,
+                      const uint64_t* sizes,
+                      int count)
+{
+  uint64_t i = 0;
+
+  for (; i + sizeof(__m256i) <= bytes; i += sizeof(__m256i))
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i*) &sieve[i]);
+
+    for (int j = 0; j < count; j++)
+    {
+      __m256i p = _mm256_loadu_si256((const __m256i*) &patterns[j][pos[j]]);
+      v = _mm256_and_si256(v, p);
+      pos[j] += sizeof(__m256i);
+      pos[j] -= (pos[j] >= sizes[j]) ? sizes[j] : 0;
+    }
+
+    _mm256_storeu_si256((__m256i*) &sieve[i], v);
+  }
+
+  for (; i < bytes; i++)
+  {
+    for (int j = 0; j < count; j++)
+    {
+      sieve[i] &= patterns[j][pos[j]];
+      pos[j] += 1;
+      pos[j] -= (pos[j] >= sizes[j]) ? sizes[j] : 0;
+    }
+  }
+}
+
+#endif
+
+#if defined(ENABLE_AVX512_BW) || \
+    defined(ENABLE_MULTIARCH_AVX512_BW)
+
+/// The group size is a template parameter so that the
+/// compiler keeps the pattern positions in registers.
+template <int COUNT>
+#if defined(ENABLE_MULTIARCH_AVX512_BW)
+  __attribute__ ((target ("avx512f,avx512bw")))
+#endif
+void andPatterns_avx512(uint8_t* sieve,
+                        uint64_t bytes,
+                        const uint8_t* const* patterns,
+                        uint64_t* pos,
+                        const uint64_t* sizes)
+{
+  const uint8_t* pattern[COUNT];
+  uint64_t p[COUNT];
+  uint64_t size[COUNT];
+
+  for (int j = 0; j < COUNT; j++)
+  {
+    pattern[j] = patterns[j];
+    p[j] = pos[j];
+    size[j] = sizes[j];
+  }
+
+  uint64_t i = 0;
+
+  // Process 4 vectors per iteration, the pattern
+  // padding ensures we don't read past the end.
+  for (; i + sizeof(__m512i) * 4 <= bytes; i += sizeof(__m512i) * 4)
+  {
+    __m512i v0 = _mm512_loadu_si512((const __m512i*) &sieve[i + 0]);
+    __m512i v1 = _mm512_loadu_si512((const __m512i*) &sieve[i + 64]);
+    __m512i v2 = _mm512_loadu_si512((const __m512i*) &sieve[i + 128]);
+    __m512i v3 = _mm512_loadu_si512((const __m512i*) &sieve[i + 192]);
+
+    for (int j = 0; j < COUNT; j++)
+    {
+      const uint8_t* pat = &pattern[j][p[j]];
+      v0 = _mm512_and_si512(v0, _mm512_loadu_si512((const __m512i*) &pat[0]));
+      v1 = _mm512_and_si512(v1, _mm512_loadu_si512((const __m512i*) &pat[64]));
+      v2 = _mm512_and_si512(v2, _mm512_loadu_si512((const __m512i*) &pat[128]));
+      v3 = _mm512_and_si512(v3, _mm512_loadu_si512((const __m512i*) &pat[192]));
+      p[j] += sizeof(__m512i) * 4;
+      p[j] = (p[j] >= size[j]) ? p[j] - size[j] : p[j];
+    }
+
+    _mm512_storeu_si512((__m512i*) &sieve[i + 0], v0);
+    _mm512_storeu_si512((__m512i*) &sieve[i + 64], v1);
+    _mm512_storeu_si512((__m512i*) &sieve[i + 128], v2);
+    _mm512_storeu_si512((__m512i*) &sieve[i + 192], v3);
+  }
+
+  for (; i < bytes; i += sizeof(__m512i))
+  {
+    uint64_t n = std::min(bytes - i, (uint64_t) sizeof(__m512i));
+    __mmask64 mask = 0xffffffffffffffffull >> (sizeof(__m512i) - n);
+    __m512i v = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &sieve[i]);
+
+    for (int j = 0; j < COUNT; j++)
+    {
+      v = _mm512_and_si512(v, _mm512_loadu_si512((const __m512i*) &pattern[j][p[j]]));
+      p[j] += n;
+      p[j] = (p[j] >= size[j]) ? p[j] - size[j] : p[j];
+    }
+
+    _mm512_mask_storeu_epi8((__m512i*) &sieve[i], mask, v);
+  }
+
+  for (int j = 0; j < COUNT; j++)
+    pos[j] = p[j];
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_BW)
+  __attribute__ ((target ("avx512f,avx512bw")))
+#endif
+void andPatterns_avx512(uint8_t* sieve,
+                        uint64_t bytes,
+                        const uint8_t* const* patterns,
+                        uint64_t* pos,
+                        const uint64_t* sizes,
+                        int count)
+{
+  switch (count)
+  {
+    case 1: andPatterns_avx512<1>(sieve, bytes, patterns, pos, sizes); break;
+    case 2: andPatterns_avx512<2>(sieve, bytes, patterns, pos, sizes); break;
+    case 3: andPatterns_avx512<3>(sieve, bytes, patterns, pos, sizes); break;
+    default: andPatterns_avx512<4>(sieve, bytes, patterns, pos, sizes); break;
+  }
+}
+
+#endif
+
+/// Returns true if the CPU supports a vector instruction
+/// set for which pattern sieving is faster than crossing
+/// off multiples one byte at a time.
+///
+bool hasPatternSieving()
+{
+#if defined(ENABLE_AVX512_BW) || \
+    defined(ENABLE_AVX2)
+  return true;
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    if (cpu_supports_avx512_bw)
+      return true;
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+      return true;
+  #endif
+
+  return false;
+#endif
+}
+
+/// sieve[i] &= patterns[j][pos[j] + i] for all j < count.
+/// Uses the widest vector instruction set supported
+/// by the CPU. Must only be called if
+/// hasPatternSieving() returns true.
+///
+void andPatterns(uint8_t* sieve,
+                 uint64_t bytes,
+                 const uint8_t* const* patterns,
+                 uint64_t* pos,
+                 const uint64_t* sizes,
+                 int count)
+{
+#if defined(ENABLE_AVX512_BW)
+  andPatterns_avx512(sieve, bytes, patterns, pos, sizes, count);
+#elif defined(ENABLE_AVX2)
+  andPatterns_avx2(sieve, bytes, patterns, pos, sizes, count);
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    if (cpu_supports_avx512_bw)
+    {
+      andPatterns_avx512(sieve, bytes, patterns, pos, sizes, count);
+      return;
+    }
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+    {
+      andPatterns_avx2(sieve, bytes, patterns, pos, sizes, count);
+      return;
+    }
+  #endif
+
+  // Unreachable, see hasPatternSieving()
+  (void) sieve; (void) bytes; (void) patterns;
+  (void) pos; (void) sizes; (void) count;
+#endif
+}
+
+} // namespace
+
 namespace primesieve {
 
-/// @stop:        Upper bound for sieving
-/// @l1CacheSize: CPU L1 cache size
-/// @maxPrime:    Sieving primes <= maxPrime
+/// @stop:            Upper bound for sieving
+/// @l1CacheSize:     CPU L1 cache size
+/// @maxPrime:        Sieving primes <= maxPrime
+/// @maxPatternPrime: Sieving primes <= maxPatternPrime are
+///                   crossed off using bit patterns
 ///
 void EratSmall::init(uint64_t stop,
                      uint64_t l1CacheSize,
-                     uint64_t maxPrime)
+                     uint64_t maxPrime,
+                     uint64_t maxPatternPrime)
 {
   assert((maxPrime / 30) * getMaxFactor() + getMaxFactor() <= SievingPrime::MAX_MULTIPLEINDEX);
   static_assert(config::FACTOR_ERATSMALL <= 4.5,
@@ -55,11 +312,71 @@ void EratSmall::init(uint64_t stop,
 
   stop_ = stop;
   maxPrime_ = maxPrime;
+  maxPatternPrime_ = std::min(maxPrime, maxPatternPrime);
+
+  if (!hasPatternSieving())
+    maxPatternPrime_ = 0;
   l1CacheSize_ = l1CacheSize;
   size_t count = primeCountApprox(maxPrime);
   primes_.reserve(count);
 }
 
+void EratSmall::addSievingPrime(uint64_t prime,
+                                uint64_t segmentLow)
+{
+  if (prime <= maxPatternPrime_)
+    addPatternPrime(prime, segmentLow);
+  else
+    Wheel30_t::addSievingPrime(prime, segmentLow);
+}
+
+/// Each byte of the sieve array corresponds to the integers
+/// segmentLow + i * 30 + { 7, 11, 13, 17, 19, 23, 29, 31 }.
+/// The prime's bit pattern is periodic, after prime bytes
+/// (= prime * 30 integers) the pattern repeats itself. Within
+/// each period there are exactly 8 multiples of the prime
+/// that are coprime to 30, we remove these from the pattern.
+///
+void EratSmall::addPatternPrime(uint64_t prime,
+                                uint64_t segmentLow)
+{
+  // prime not needed for sieving
+  if (prime * prime > stop_)
+    return;
+
+  PatternPrime patternPrime;
+  patternPrime.offset = patterns_.size();
+  patternPrime.size = ceilDiv(PATTERN_PADDING, prime) * prime;
+  patternPrime.pos = (segmentLow / 30) % prime;
+  patternPrime.primeIndex = ~0ull;
+  patternPrime.primeBit = 0;
+
+  // The pattern also removes the prime itself
+  if (prime >= segmentLow + 7)
+  {
+    uint64_t i = (prime - segmentLow - 7) / 30;
+    uint64_t offset = prime - segmentLow - i * 30;
+    patternPrime.primeIndex = i;
+    patternPrime.primeBit = (uint8_t) (1 << offsetBitIndex[offset]);
+  }
+
+  patterns_.resize(patterns_.size() + patternPrime.size + PATTERN_PADDING, 0xff);
+  uint8_t* pattern = &patterns_[patternPrime.offset];
+
+  for (uint64_t q : { 1, 7, 11, 13, 17, 19, 23, 29 })
+  {
+    uint64_t multiple = prime * q;
+    uint64_t i = (multiple - 7) / 30;
+    uint64_t offset = multiple - i * 30;
+    pattern[i] &= ~(1 << offsetBitIndex[offset]);
+  }
+
+  for (uint64_t i = prime; i < patternPrime.size + PATTERN_PADDING; i++)
+    pattern[i] = pattern[i - prime];
+
+  patternPrimes_.push_back(patternPrime);
+}
+
 /// Add a new sieving prime to EratSmall
 void EratSmall::storeSievingPrime(uint64_t prime,
                                   uint64_t multipleIndex,
@@ -84,10 +401,58 @@ void EratSmall::crossOff(uint8_t* sieve, uint64_t sieveSize)
   {
     uint64_t end = i + l1CacheSize_;
     end = std::min(end, sieveSize);
+    crossOffPatterns(&sieve[i], end - i);
     crossOff(&sieve[i], &sieve[end]);
   }
 }
 
+/// Remove the multiples of the pattern primes by
+/// ANDing their bit patterns into the sieve array.
+///
+void EratSmall::crossOffPatterns(uint8_t* sieve, uint64_t sieveSize)
+{
+  const uint8_t* patterns[MAX_GROUP];
+  uint64_t pos[MAX_GROUP];
+  uint64_t sizes[MAX_GROUP];
+  uint8_t primeBytes[MAX_GROUP];
+
+  for (std::size_t i = 0; i < patternPrimes_.size(); i += MAX_GROUP)
+  {
+    std::size_t end = std::min(i + MAX_GROUP, patternPrimes_.size());
+    int count = (int) (end - i);
+
+    for (int j = 0; j < count; j++)
+    {
+      PatternPrime& patternPrime = patternPrimes_[i + j];
+      patterns[j] = &patterns_[patternPrime.offset];
+      pos[j] = patternPrime.pos;
+      sizes[j] = patternPrime.size;
+      if (patternPrime.primeIndex < sieveSize)
+        primeBytes[j] = sieve[patternPrime.primeIndex];
+    }
+
+    andPatterns(sieve, sieveSize, patterns, pos, sizes, count);
+
+    for (int j = 0; j < count; j++)
+    {
+      PatternPrime& patternPrime = patternPrimes_[i + j];
+      patternPrime.pos = pos[j];
+
+      // The pattern has also removed the prime itself
+      if (patternPrime.primeIndex != ~0ull)
+      {
+        if (patternPrime.primeIndex < sieveSize)
+        {
+          sieve[patternPrime.primeIndex] |= primeBytes[j] & patternPrime.primeBit;
+          patternPrime.primeIndex = ~0ull;
+        }
+        else
+          patternPrime.primeIndex -= sieveSize;
+      }
+    }
+  }
+}
+
 /// Segmented sieve of Eratosthenes with wheel factorization
 /// optimized for small sieving primes that have many multiples
 /// per segment. This algorithm uses a hardcoded modulo 30
@@ -0,0 +1,146 @@
+///
+/// @file   GapStats.cpp
+/// @brief  Prime gap statistics: histogram of the gaps between
+///         consecutive primes, first occurrence of each gap size
+///         and maximal (record) gaps.
+///
+///         When sieving in parallel each thread sieves many
+///         small intervals. The gaps inside each interval are
+///         merged using mergeGaps() and the gaps between
+///         consecutive intervals are added afterwards using
+///         addInterval() in increasing order.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/GapStats.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace primesieve {
+
+void GapStats::reset()
+{
+  firstPrime_ = 0;
+  lastPrime_ = 0;
+  histogram_.clear();
+  firstOccurrence_.clear();
+}
+
+/// Add the primes of an interval that follows the primes
+/// added so far, i.e. the gap between lastPrime_ and
+/// firstPrime. The gaps inside the interval must be added
+/// separately using mergeGaps().
+///
+void GapStats::addInterval(uint64_t firstPrime, uint64_t lastPrime)
+{
+  if (!firstPrime)
+    return;
+
+  if (lastPrime_)
+  {
+    // The gaps of the following intervals may have
+    // been merged already, hence this gap is not
+    // necessarily the first occurrence.
+    uint64_t gap = firstPrime - lastPrime_;
+    addGap(lastPrime_, firstPrime);
+    firstOccurrence_[gap] = std::min(firstOccurrence_[gap], lastPrime_);
+  }
+  else
+    firstPrime_ = firstPrime;
+
+  lastPrime_ = lastPrime;
+}
+
+/// Merge the histogram and the first occurrences of
+/// other into this object. The gap between the two
+/// intervals is not added.
+///
+void GapStats::mergeGaps(const GapStats& other)
+{
+  const auto& histogram = other.histogram_;
+
+  if (histogram.size() > histogram_.size())
+  {
+    histogram_.resize(histogram.size(), 0);
+    firstOccurrence_.resize(histogram.size(), 0);
+  }
+
+  for (std::size_t gap = 0; gap < histogram.size(); gap++)
+  {
+    if (histogram[gap])
+    {
+      uint64_t prime = other.firstOccurrence_[gap];
+      if (histogram_[gap] == 0 ||
+          prime < firstOccurrence_[gap])
+        firstOccurrence_[gap] = prime;
+      histogram_[gap] += histogram[gap];
+    }
+  }
+}
+
+/// Append the gap statistics of the next interval
+void GapStats::append(const GapStats& next)
+{
+  mergeGaps(next);
+  addInterval(next.firstPrime_, next.lastPrime_);
+}
+
+uint64_t GapStats::getMaxGap() const
+{
+  for (std::size_t gap = histogram_.size(); gap > 0; gap--)
+    if (histogram_[gap - 1])
+      return gap - 1;
+
+  return 0;
+}
+
+uint64_t GapStats::getCount(uint64_t gap) const
+{
+  if (gap < histogram_.size())
+    return histogram_[gap];
+  else
+    return 0;
+}
+
+/// Returns 0 if there is no such gap
+uint64_t GapStats::getFirstOccurrence(uint64_t gap) const
+{
+  if (gap < histogram_.size() &&
+      histogram_[gap])
+    return firstOccurrence_[gap];
+  else
+    return 0;
+}
+
+/// A gap is maximal if its first occurrence is smaller
+/// than the first occurrences of all larger gaps. Hence
+/// we iterate over the gaps from largest to smallest.
+///
+std::vector<MaximalGap> GapStats::getMaximalGaps() const
+{
+  std::vector<MaximalGap> maximalGaps;
+  uint64_t minPrime = ~0ull;
+
+  for (std::size_t gap = histogram_.size(); gap > 0; gap--)
+  {
+    uint64_t prime = firstOccurrence_[gap - 1];
+    if (histogram_[gap - 1] &&
+        prime < minPrime)
+    {
+      minPrime = prime;
+      maximalGaps.push_back(MaximalGap{gap - 1, prime});
+    }
+  }
+
+  std::reverse(maximalGaps.begin(), maximalGaps.end());
+  return maximalGaps;
+}
+
+} // namespace
@@ -10,17 +10,28 @@
 
 #include <primesieve/config.hpp>
 #include <primesieve/forward.hpp>
+#include <primesieve/GapStats.hpp>
 #include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PiIndex.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/StorePrimes.hpp>
+#include <primesieve/iterator.hpp>
 
 #include <stdint.h>
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <future>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 using std::size_t;
@@ -35,6 +46,48 @@ counts_t& operator+=(counts_t& v1, const counts_t& v2)
   return v1;
 }
 
+std::vector<uint64_t>& operator+=(std::vector<uint64_t>& v1, const std::vector<uint64_t>& v2)
+{
+  v1.resize(std::max(v1.size(), v2.size()), 0);
+  for (size_t i = 0; i < v2.size(); i++)
+    v1[i] += v2[i];
+  return v1;
+}
+
+/// Smallest and largest prime of the i-th
+/// interval, used to stitch together the
+/// prime gaps of different threads.
+///
+struct Interval
+{
+  uint64_t i;
+  uint64_t firstPrime;
+  uint64_t lastPrime;
+};
+
+/// Part of a piece of the batch intervals,
+/// the unit of work of count_primes_batch().
+///
+struct Chunk
+{
+  uint64_t start;
+  uint64_t stop;
+  std::size_t piece;
+};
+
+/// Results of a single thread
+struct ThreadResult
+{
+  counts_t counts;
+  /// Primes in residue classes
+  std::vector<uint64_t> modCounts;
+  PrimeSums primeSums;
+  uint64_t constellationCount = 0;
+  /// Gaps inside the thread's intervals
+  GapStats gapStats;
+  std::vector<Interval> intervals;
+};
+
 } // namespace
 
 namespace primesieve {
@@ -125,6 +178,83 @@ bool ParallelSieve::tryUpdateStatus(uint64_t dist)
   return lock.owns_lock();
 }
 
+/// Count the primes inside [start, stop] using the pi(x)
+/// index (see PiIndex.hpp): pi(x) = pi(checkpoint) +- the
+/// primes between x and the nearest checkpoint. Hence we
+/// only sieve the distance between start, stop and their
+/// nearest checkpoints. Returns false if no index is
+/// loaded or if sieving [start, stop] is cheaper.
+///
+bool ParallelSieve::countPiIndex()
+{
+  // Keep the index alive even if set_pi_index()
+  // unloads it while we are counting.
+  std::shared_ptr<const PiIndex> index = getPiIndex();
+
+  if (!index ||
+      !isCountPrimes() ||
+      isCountkTuplets() ||
+      isCountGaps() ||
+      isCountPrimesMod() ||
+      isSumPrimes() ||
+      isConstellation() ||
+      isPrint())
+    return false;
+
+  uint64_t step = index->getStep();
+  uint64_t dist = 0;
+  std::array<uint64_t, 2> x = { start_ - 1, stop_ };
+  std::array<uint64_t, 2> k = { 0, 0 };
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (i == 0 && start_ == 0)
+      continue;
+
+    k[i] = index->nearestCheckpoint(checkedAdd(x[i], 1));
+    uint64_t checkpoint = k[i] * step;
+    if (checkpoint <= x[i])
+      dist = checkedAdd(dist, x[i] - checkpoint + 1);
+    else
+      dist = checkedAdd(dist, checkpoint - x[i] - 1);
+  }
+
+  // The edge intervals are counted using the index
+  // again, this terminates as for these
+  // intervals dist == getDistance().
+  if (dist >= getDistance())
+    return false;
+
+  auto t1 = std::chrono::system_clock::now();
+  std::array<int64_t, 2> pi = { 0, 0 };
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (i == 0 && start_ == 0)
+      continue;
+
+    ParallelSieve ps;
+    ps.setSieveSize(getSieveSize());
+    ps.setTuneSettings(getTuneSettings());
+    ps.setNumThreads(numThreads_);
+    uint64_t checkpoint = k[i] * step;
+    pi[i] = index->getPi(k[i]);
+
+    if (checkpoint <= x[i])
+      pi[i] += ps.countPrimes(checkpoint, x[i]);
+    else
+      pi[i] -= ps.countPrimes(x[i] + 1, checkpoint - 1);
+  }
+
+  counts_[0] = pi[1] - pi[0];
+  auto t2 = std::chrono::system_clock::now();
+  std::chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+  setStatus(100);
+
+  return true;
+}
+
 /// Sieve the primes and prime k-tuplets in [start, stop]
 /// in parallel using multi-threading.
 ///
@@ -135,6 +265,9 @@ void ParallelSieve::sieve()
   if (start_ > stop_)
     return;
 
+  if (countPiIndex())
+    return;
+
   int threads = idealNumThreads();
 
   if (threads == 1)
@@ -164,8 +297,8 @@ void ParallelSieve::sieve()
       preSieve.init(0, dist / threads);
 
       uint64_t i;
-      counts_t counts;
-      counts.fill(0);
+      ThreadResult res;
+      res.counts.fill(0);
 
       while ((i = a.fetch_add(1, std::memory_order_relaxed)) < iters)
       {
@@ -177,21 +310,59 @@ void ParallelSieve::sieve()
           start = align(start) + 1;
 
         // Sieve the primes inside [start, stop]
-        ps.sieve(start, stop);
-        counts += ps.getCounts();
+        if (!isConstellation())
+          ps.sieve(start, stop);
+        else
+        {
+          // Constellations whose first prime is <= stop
+          // may end in the next thread's interval.
+          uint64_t width = getPattern().back();
+          ps.setMaxFirstPrime(stop);
+          ps.sieve(start, std::min(checkedAdd(stop, width), stop_));
+          res.constellationCount += ps.getConstellationCount();
+        }
+
+        res.counts += ps.getCounts();
+        res.modCounts += ps.getModCounts();
+        res.primeSums.add(ps.getPrimeSums());
+
+        if (isCountGaps())
+        {
+          GapStats& gapStats = ps.getGapStats();
+          res.gapStats.mergeGaps(gapStats);
+          if (!gapStats.empty())
+            res.intervals.push_back(Interval{i, gapStats.getFirstPrime(), gapStats.getLastPrime()});
+        }
       }
 
-      return counts;
+      return res;
     };
 
-    std::vector<std::future<counts_t>> futures;
+    std::vector<std::future<ThreadResult>> futures;
     futures.reserve(threads);
 
     for (int t = 0; t < threads; t++)
       futures.emplace_back(std::async(std::launch::async, task));
 
+    std::vector<Interval> intervals;
+
     for (auto& f : futures)
-      counts_ += f.get();
+    {
+      ThreadResult res = f.get();
+      counts_ += res.counts;
+      modCounts_ += res.modCounts;
+      primeSums_.add(res.primeSums);
+      constellationCount_ += res.constellationCount;
+      gapStats_.mergeGaps(res.gapStats);
+      intervals.insert(intervals.end(), res.intervals.begin(), res.intervals.end());
+    }
+
+    // Add the gaps between consecutive intervals
+    std::sort(intervals.begin(), intervals.end(),
+              [](const Interval& a, const Interval& b) { return a.i < b.i; });
+
+    for (const auto& interval : intervals)
+      gapStats_.addInterval(interval.firstPrime, interval.lastPrime);
 
     auto t2 = std::chrono::system_clock::now();
     std::chrono::duration<double> seconds = t2 - t1;
@@ -200,4 +371,386 @@ void ParallelSieve::sieve()
   }
 }
 
+/// Count the primes inside many intervals [start, stop].
+/// The intervals are split at all of their start and stop
+/// numbers into disjoint pieces, each piece is sieved only
+/// once even if it belongs to many (overlapping) intervals.
+/// The sieving primes <= sqrt(max(stop)) are generated only
+/// once and shared by all threads, each thread reuses its
+/// PrimeSieve object (and its pre-sieve buffers) for all of
+/// its pieces.
+///
+/// @return counts[i] = number of primes inside intervals[i]
+///
+std::vector<uint64_t> ParallelSieve::countPrimes(const std::vector<std::pair<uint64_t, uint64_t>>& intervals)
+{
+  const uint64_t maxStop = std::numeric_limits<uint64_t>::max();
+  std::vector<uint64_t> counts(intervals.size(), 0);
+  std::vector<uint64_t> bounds;
+
+  // Piece k = [bounds[k], bounds[k + 1] - 1]
+  for (const auto& interval : intervals)
+  {
+    if (interval.first <= interval.second)
+    {
+      bounds.push_back(interval.first);
+      if (interval.second < maxStop)
+        bounds.push_back(interval.second + 1);
+    }
+  }
+
+  if (bounds.empty())
+    return counts;
+
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+  auto getPiece = [&](uint64_t n)
+  {
+    return (std::size_t) (std::lower_bound(bounds.begin(), bounds.end(), n) - bounds.begin());
+  };
+
+  // Find the pieces that belong to at least one interval
+  std::vector<int64_t> covered(bounds.size() + 1, 0);
+  uint64_t high = 0;
+
+  for (const auto& interval : intervals)
+  {
+    if (interval.first <= interval.second)
+    {
+      covered[getPiece(interval.first)]++;
+      if (interval.second < maxStop)
+        covered[getPiece(interval.second + 1)]--;
+      high = std::max(high, interval.second);
+    }
+  }
+
+  for (std::size_t k = 1; k < covered.size(); k++)
+    covered[k] += covered[k - 1];
+
+  auto getPieceStop = [&](std::size_t k)
+  {
+    return (k + 1 < bounds.size()) ? bounds[k + 1] - 1 : maxStop;
+  };
+
+  uint64_t dist = 0;
+  for (std::size_t k = 0; k < bounds.size(); k++)
+    if (covered[k] > 0)
+      dist = checkedAdd(dist, getPieceStop(k) - bounds[k]);
+
+  // Split large pieces into chunks in order
+  // to distribute the work evenly to all threads.
+  int threads = numThreads_;
+  uint64_t sqrtHigh = isqrt(high);
+  uint64_t chunkDist = std::min(sqrtHigh * 1000, dist / threads);
+  chunkDist = std::max(chunkDist, config::MIN_THREAD_DISTANCE);
+  std::vector<Chunk> chunks;
+
+  for (std::size_t k = 0; k < bounds.size(); k++)
+  {
+    if (covered[k] > 0)
+    {
+      uint64_t pieceStop = getPieceStop(k);
+
+      for (uint64_t low = bounds[k]; true; low += chunkDist)
+      {
+        uint64_t chunkStop = std::min(checkedAdd(low, chunkDist - 1), pieceStop);
+        chunks.push_back(Chunk{low, chunkStop, k});
+        if (chunkStop == pieceStop)
+          break;
+      }
+    }
+  }
+
+  // Generate the sieving primes only once
+  uint64_t maxSievingPrime = std::min(sqrtHigh, config::MAX_SHARED_SIEVING_PRIME);
+  std::vector<uint32_t> sievingPrimes;
+  store_primes(0, maxSievingPrime, sievingPrimes);
+
+  setFlags(COUNT_PRIMES);
+  threads = inBetween(1, threads, chunks.size());
+  std::atomic<std::size_t> a(0);
+
+  // Each thread executes 1 task
+  auto task = [&]()
+  {
+    PrimeSieve ps(this);
+    PreSieve& preSieve = ps.getPreSieve();
+    preSieve.init(0, dist / threads);
+    std::vector<uint64_t> pieceCounts(bounds.size(), 0);
+    std::size_t i;
+
+    while ((i = a.fetch_add(1, std::memory_order_relaxed)) < chunks.size())
+    {
+      const Chunk& chunk = chunks[i];
+
+      if (isqrt(chunk.stop) <= maxSievingPrime)
+        ps.setSievingPrimes(&sievingPrimes);
+      else
+        ps.setSievingPrimes(nullptr);
+
+      ps.sieve(chunk.start, chunk.stop);
+      pieceCounts[chunk.piece] += ps.getCount(0);
+    }
+
+    return pieceCounts;
+  };
+
+  std::vector<std::future<std::vector<uint64_t>>> futures;
+  futures.reserve(threads);
+
+  for (int t = 0; t < threads; t++)
+    futures.emplace_back(std::async(std::launch::async, task));
+
+  std::vector<uint64_t> pieceCounts(bounds.size() + 1, 0);
+
+  for (auto& f : futures)
+  {
+    std::vector<uint64_t> res = f.get();
+    for (std::size_t k = 0; k < res.size(); k++)
+      pieceCounts[k + 1] += res[k];
+  }
+
+  // pieceCounts[k] = primes inside the pieces < k
+  for (std::size_t k = 1; k < pieceCounts.size(); k++)
+    pieceCounts[k] += pieceCounts[k - 1];
+
+  for (std::size_t i = 0; i < intervals.size(); i++)
+  {
+    uint64_t start = intervals[i].first;
+    uint64_t stop = intervals[i].second;
+
+    if (start <= stop)
+    {
+      std::size_t first = getPiece(start);
+      std::size_t last = bounds.size();
+      if (stop < maxStop)
+        last = getPiece(stop + 1);
+      counts[i] = pieceCounts[last] - pieceCounts[first];
+    }
+  }
+
+  return counts;
+}
+
+/// Store the primes inside [start, stop] in parallel using
+/// two passes. First the primes of each chunk are counted in
+/// parallel, this gives the exact offset of each chunk's
+/// primes and the vector is resized only once. Then each
+/// thread generates the primes of its chunks directly into
+/// their slice of the vector.
+///
+/// @return false if [start, stop] is too small for
+///         multi-threading, nothing is stored in this case.
+///
+bool ParallelSieve::storePrimes(ParallelStore& store)
+{
+  if (start_ > stop_)
+    return false;
+
+  int threads = idealNumThreads();
+  if (threads < 2)
+    return false;
+
+  uint64_t threadDist = getThreadDistance(threads);
+  std::vector<std::pair<uint64_t, uint64_t>> chunks;
+
+  for (uint64_t low = start_; true; low += threadDist)
+  {
+    uint64_t high = std::min(checkedAdd(low, threadDist - 1), stop_);
+    chunks.emplace_back(low, high);
+    if (high == stop_)
+      break;
+  }
+
+  // 1st pass: count the primes of each chunk
+  std::vector<uint64_t> counts = countPrimes(chunks);
+  std::vector<size_t> offsets(chunks.size() + 1, 0);
+
+  for (size_t i = 0; i < chunks.size(); i++)
+    offsets[i + 1] = offsets[i] + (size_t) counts[i];
+
+  store.resize(offsets.back());
+  threads = inBetween(1, threads, chunks.size());
+  std::atomic<size_t> a(0);
+
+  // 2nd pass: each thread executes 1 task
+  auto task = [&]()
+  {
+    size_t i;
+
+    while ((i = a.fetch_add(1, std::memory_order_relaxed)) < chunks.size())
+    {
+      uint64_t start = chunks[i].first;
+      uint64_t stop = chunks[i].second;
+      size_t count = offsets[i + 1] - offsets[i];
+
+      // Generates the primes > start - 1
+      iterator it((start > 0) ? start - 1 : 0, stop);
+      if (store.fill(it, offsets[i], count, stop) != count)
+        throw primesieve_error("storePrimes: invalid number of primes");
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(threads);
+
+  for (int t = 0; t < threads; t++)
+    futures.emplace_back(std::async(std::launch::async, task));
+
+  for (auto& f : futures)
+    f.get();
+
+  return true;
+}
+
+/// Pass the sieve array of each segment of [start, stop]
+/// to the callback using multi-threading (see
+/// sieve_bitmap()). The chunk boundaries are aligned to
+/// n % 30 == 7 (the first number of a sieve byte), hence
+/// the sieve arrays of different chunks never overlap.
+///
+/// If ordered is false, the callback is executed
+/// concurrently by all threads. If ordered is true, the
+/// segments are delivered one at a time in increasing order.
+/// A thread whose chunk's turn has not come yet copies its
+/// segments into a buffer which it delivers as soon as all
+/// preceding chunks have been delivered, afterwards its
+/// segments are delivered without copying.
+///
+void ParallelSieve::sieveBitmap(const BitmapCallback& callback, bool ordered)
+{
+  setFlags(SIEVE_BITMAP);
+  setBitmapCallback(&callback);
+  int threads = idealNumThreads();
+
+  if (threads < 2)
+  {
+    PrimeSieve::sieve();
+    return;
+  }
+
+  reset();
+  setStatus(0);
+  auto t1 = std::chrono::system_clock::now();
+  uint64_t dist = getDistance();
+  uint64_t threadDist = getThreadDistance(threads);
+
+  if (ordered)
+    threadDist = std::min(threadDist, config::MAX_ORDERED_BITMAP_BYTES * 30);
+
+  uint64_t iters = ((dist - 1) / threadDist) + 1;
+  threads = inBetween(1, threads, iters);
+  std::atomic<uint64_t> a(0);
+  std::mutex mutex;
+  std::condition_variable turnChanged;
+  uint64_t turn = 0;
+  bool failed = false;
+
+  // Each thread executes 1 task
+  auto task = [&]()
+  {
+    PrimeSieve ps(this);
+    PreSieve& preSieve = ps.getPreSieve();
+    preSieve.init(0, dist / threads);
+
+    std::vector<uint8_t> buffer;
+    std::vector<std::pair<uint64_t, size_t>> segments;
+    bool isTurn = !ordered;
+    uint64_t i = 0;
+
+    auto flush = [&]()
+    {
+      const uint8_t* bits = buffer.data();
+      for (const auto& segment : segments)
+      {
+        callback(segment.first, bits, segment.second);
+        bits += ceilDiv(segment.second, 8) * 8;
+      }
+      buffer.clear();
+      segments.clear();
+    };
+
+    BitmapCallback segmentCallback = [&](uint64_t low, const uint8_t* bits, size_t bytes)
+    {
+      if (!isTurn)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          isTurn = (turn == i);
+        }
+        if (!isTurn)
+        {
+          // Including the zero padding up to the next multiple of 8
+          buffer.insert(buffer.end(), bits, bits + ceilDiv(bytes, 8) * 8);
+          segments.emplace_back(low, bytes);
+          return;
+        }
+        flush();
+      }
+
+      callback(low, bits, bytes);
+    };
+
+    ps.setBitmapCallback(&segmentCallback);
+
+    try
+    {
+      while ((i = a.fetch_add(1, std::memory_order_relaxed)) < iters)
+      {
+        uint64_t start = start_ + threadDist * i;
+        uint64_t stop = checkedAdd(start, threadDist);
+
+        // Next chunk starts at stop - stop % 30 + 7
+        if (stop >= stop_)
+          stop = stop_;
+        else
+          stop = stop - stop % 30 + 6;
+
+        if (start > start_)
+          start = start - start % 30 + 7;
+
+        isTurn = !ordered;
+        ps.sieve(start, stop);
+
+        if (ordered)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          turnChanged.wait(lock, [&] { return turn == i || failed; });
+          if (failed)
+            return;
+          lock.unlock();
+          flush();
+          lock.lock();
+          turn++;
+          turnChanged.notify_all();
+        }
+      }
+    }
+    catch (...)
+    {
+      // Wake up the threads waiting for their turn
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+      turnChanged.notify_all();
+      a = iters;
+      throw;
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(threads);
+
+  for (int t = 0; t < threads; t++)
+    futures.emplace_back(std::async(std::launch::async, task));
+
+  for (auto& f : futures)
+    f.get();
+
+  auto t2 = std::chrono::system_clock::now();
+  std::chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+  setStatus(100);
+}
+
 } // namespace
@@ -0,0 +1,259 @@
+///
+/// @file   PiIndex.cpp
+/// @brief  Build, load and query the pi(x) checkpoint index,
+///         see PiIndex.hpp for the file format. The index is
+///         built in parallel using count_primes_batch() as each
+///         step between consecutive checkpoints is an
+///         independent interval.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PiIndex.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace primesieve;
+
+namespace {
+
+const char magic[8] = { 'P', 'R', 'I', 'M', 'E', 'P', 'I', '1' };
+
+struct Header
+{
+  char magic[8];
+  uint64_t step;
+  uint64_t size;
+};
+
+std::shared_ptr<const PiIndex> loadEnvPiIndex()
+{
+  const char* filename = std::getenv("PRIMESIEVE_PI_INDEX");
+  if (!filename || !*filename)
+    return nullptr;
+
+  // Like the tune file an unusable index
+  // file is ignored (we simply sieve).
+  try
+  {
+    return std::make_shared<const PiIndex>(filename);
+  }
+  catch (primesieve_error&)
+  {
+    return nullptr;
+  }
+}
+
+/// Guards the loaded index, set_pi_index()
+/// may replace it while other threads sieve.
+///
+std::mutex piIndexMutex;
+
+/// Must be called with piIndexMutex locked
+std::shared_ptr<const PiIndex>& piIndex()
+{
+  static std::shared_ptr<const PiIndex> index = loadEnvPiIndex();
+  return index;
+}
+
+} // namespace
+
+namespace primesieve {
+
+PiIndex::PiIndex(const std::string& filename)
+{
+  Header header;
+  std::size_t bytes = 0;
+
+#if defined(_WIN32)
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file)
+    throw primesieve_error("pi index: failed to open " + filename);
+
+  bytes = (std::size_t) file.tellg();
+  file.seekg(0);
+  if (bytes < sizeof(Header) ||
+      !file.read((char*) &header, sizeof(Header)))
+    throw primesieve_error("pi index: invalid file " + filename);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw primesieve_error("pi index: failed to open " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) == 0)
+    bytes = (std::size_t) st.st_size;
+
+  if (bytes >= sizeof(Header))
+  {
+    map_ = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (map_ == MAP_FAILED)
+      map_ = nullptr;
+  }
+
+  close(fd);
+  if (!map_)
+    throw primesieve_error("pi index: invalid file " + filename);
+
+  mapBytes_ = bytes;
+  std::memcpy(&header, map_, sizeof(Header));
+#endif
+
+  step_ = header.step;
+  size_ = header.size;
+
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+      step_ == 0 ||
+      size_ > (bytes - sizeof(Header)) / sizeof(uint64_t) ||
+      bytes != sizeof(Header) + size_ * sizeof(uint64_t) ||
+      size_ > ~0ull / step_)
+  {
+#if !defined(_WIN32)
+    munmap(map_, mapBytes_);
+    map_ = nullptr;
+#endif
+    throw primesieve_error("pi index: invalid file " + filename);
+  }
+
+#if defined(_WIN32)
+  buffer_.resize(size_);
+  if (!file.read((char*) buffer_.data(), size_ * sizeof(uint64_t)))
+    throw primesieve_error("pi index: invalid file " + filename);
+  pi_ = buffer_.data();
+#else
+  pi_ = (const uint64_t*) ((const char*) map_ + sizeof(Header));
+#endif
+
+  // Reject corrupted index files, pi(x) is
+  // non-decreasing and pi(x) <= x / 2 + 1.
+  for (uint64_t k = 1; k <= size_; k++)
+  {
+    if (getPi(k) < getPi(k - 1) ||
+        getPi(k) > k * step_ / 2 + 1)
+    {
+#if !defined(_WIN32)
+      munmap(map_, mapBytes_);
+      map_ = nullptr;
+#endif
+      throw primesieve_error("pi index: invalid file " + filename);
+    }
+  }
+}
+
+PiIndex::~PiIndex()
+{
+#if !defined(_WIN32)
+  if (map_)
+    munmap(map_, mapBytes_);
+#endif
+}
+
+/// Returns k so that k * step is the checkpoint
+/// nearest to n, k <= size().
+///
+uint64_t PiIndex::nearestCheckpoint(uint64_t n) const
+{
+  if (n >= getMaxCheckpoint())
+    return size_;
+
+  uint64_t k = n / step_;
+  if (n - k * step_ > step_ / 2)
+    k++;
+
+  return k;
+}
+
+std::shared_ptr<const PiIndex> getPiIndex()
+{
+  std::lock_guard<std::mutex> lock(piIndexMutex);
+  return piIndex();
+}
+
+/// Load the pi(x) index file used by count_primes() and
+/// nth_prime(), an empty filename unloads the index.
+/// The old index is unmapped once the last thread
+/// that is using it has finished.
+///
+void set_pi_index(const std::string& filename)
+{
+  std::shared_ptr<const PiIndex> index;
+  if (!filename.empty())
+    index = std::make_shared<const PiIndex>(filename);
+
+  std::lock_guard<std::mutex> lock(piIndexMutex);
+  piIndex().swap(index);
+}
+
+/// Build the pi(x) index file for the checkpoints
+/// step, 2 * step, ..., <= stop.
+///
+void build_pi_index(const std::string& filename,
+                    uint64_t stop,
+                    uint64_t step)
+{
+  if (step == 0)
+    throw primesieve_error("build_pi_index: step must be > 0");
+
+  uint64_t size = stop / step;
+  std::vector<std::pair<uint64_t, uint64_t>> intervals;
+  intervals.reserve(size);
+
+  for (uint64_t k = 0; k < size; k++)
+    intervals.emplace_back(k * step, k * step + (step - 1));
+
+  ParallelSieve ps;
+  std::vector<uint64_t> pi = ps.countPrimes(intervals);
+
+  for (std::size_t i = 1; i < pi.size(); i++)
+    pi[i] += pi[i - 1];
+
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.step = step;
+  header.size = size;
+
+  // The old index file may currently be memory mapped,
+  // hence we must not overwrite it in place.
+  std::string tmpFile = filename + ".tmp";
+
+  {
+    std::ofstream file(tmpFile, std::ios::binary | std::ios::trunc);
+    file.write((const char*) &header, sizeof(Header));
+    file.write((const char*) pi.data(), pi.size() * sizeof(uint64_t));
+
+    if (!file)
+      throw primesieve_error("build_pi_index: failed to write " + tmpFile);
+  }
+
+  if (std::rename(tmpFile.c_str(), filename.c_str()) != 0)
+  {
+    std::remove(filename.c_str());
+    if (std::rename(tmpFile.c_str(), filename.c_str()) != 0)
+      throw primesieve_error("build_pi_index: failed to write " + filename);
+  }
+}
+
+} // namespace
@@ -1,7 +1,7 @@
 ///
 /// @file   PreSieve.cpp
-/// @brief  Pre-sieve multiples of small primes < 100 to speed up the
-///         sieve of Eratosthenes. The idea is to allocate several
+/// @brief  Pre-sieve multiples of small primes <= 167 to speed up
+///         the sieve of Eratosthenes. The idea is to allocate several
 ///         arrays (buffers_) and remove the multiples of small primes
 ///         from them at initialization. Each buffer is assigned
 ///         different primes, for example:
@@ -20,6 +20,18 @@
 ///         Pre-sieving provides a speedup of up to 30% when
 ///         sieving the primes < 10^10 using primesieve.
 ///
+///         For large sieving distances there is a second tier of
+///         7 buffers (buffersTier2_) that removes the multiples of
+///         the primes inside [101, 167]. The tier is chosen in
+///         init() based on the sieving distance and the CPU's L2
+///         cache size. The tier 2 buffers are ANDed into the
+///         already pre-sieved sieve array.
+///
+///         The bitwise AND of the buffers is memory bound and
+///         benefits from wide vector registers. Hence on x86 CPUs
+///         we dispatch at runtime to an AVX512 or AVX2 version of
+///         andBuffers() if the CPU supports it.
+///
 /// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -27,7 +39,10 @@
 ///
 
 #include <primesieve/PreSieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
 #include <primesieve/EratSmall.hpp>
+#include <primesieve/macros.hpp>
 #include <primesieve/pmath.hpp>
 
 #include <stdint.h>
@@ -36,8 +51,36 @@
 #include <cassert>
 #include <vector>
 
+#if defined(__AVX512F__) && \
+    defined(__AVX512BW__) && \
+    __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX512_BW
+
+#elif defined(__AVX2__) && \
+      __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX2
+
+#elif (defined(ENABLE_MULTIARCH_AVX512_BW) || \
+       defined(ENABLE_MULTIARCH_AVX2)) && \
+       __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_DEFAULT
+
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    #include <primesieve/cpu_supports_avx512_bw.hpp>
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    #include <primesieve/cpu_supports_avx2.hpp>
+  #endif
+#else
+  #define ENABLE_DEFAULT
+#endif
+
 using std::copy_n;
 using std::size_t;
+using primesieve::cpuInfo;
 
 namespace {
 
@@ -147,7 +190,8 @@ const std::array<uint8_t, 7*11*13> buffer_7_11_13 =
   0xc7
 };
 
-/// Pre-sieve with the primes < 100
+
+/// Tier 1: pre-sieve with the primes < 100
 const std::array<std::vector<uint64_t>, 8> bufferPrimes =
 {{
   {  7, 67, 71 },  // 32 KiB
@@ -160,6 +204,18 @@ const std::array<std::vector<uint64_t>, 8> bufferPrimes =
       { 83, 89 }   //  7 KiB
 }};
 
+/// Tier 2: pre-sieve with the primes <= 167
+const std::array<std::vector<uint64_t>, 7> bufferPrimesTier2 =
+{{
+  { 101, 167 },  // 16 KiB
+  { 103, 163 },  // 16 KiB
+  { 107, 157 },  // 16 KiB
+  { 109, 151 },  // 16 KiB
+  { 113, 149 },  // 16 KiB
+  { 127, 139 },  // 17 KiB
+  { 131, 137 }   // 18 KiB
+}};
+
 /// Each byte represents an interval of 30 integers
 const uint64_t buffersDist =
   ( 7 * 67 * 71) * 30 +
@@ -171,16 +227,27 @@ const uint64_t buffersDist =
        (79 * 97) * 30 +
        (83 * 89) * 30;
 
-void andBuffers(const uint8_t* __restrict buf1,
-                const uint8_t* __restrict buf2,
-                const uint8_t* __restrict buf3,
-                const uint8_t* __restrict buf4,
-                const uint8_t* __restrict buf5,
-                const uint8_t* __restrict buf6,
-                const uint8_t* __restrict buf7,
-                const uint8_t* __restrict buf8,
-                uint8_t* __restrict output,
-                size_t bytes)
+const uint64_t buffersDistTier2 =
+  (101 * 167) * 30 +
+  (103 * 163) * 30 +
+  (107 * 157) * 30 +
+  (109 * 151) * 30 +
+  (113 * 149) * 30 +
+  (127 * 139) * 30 +
+  (131 * 137) * 30;
+
+#if defined(ENABLE_DEFAULT)
+
+void andBuffers_default(const uint8_t* __restrict buf1,
+                        const uint8_t* __restrict buf2,
+                        const uint8_t* __restrict buf3,
+                        const uint8_t* __restrict buf4,
+                        const uint8_t* __restrict buf5,
+                        const uint8_t* __restrict buf6,
+                        const uint8_t* __restrict buf7,
+                        const uint8_t* __restrict buf8,
+                        uint8_t* __restrict output,
+                        size_t bytes)
 {
   // This loop should be auto-vectorized
   for (size_t i = 0; i < bytes; i++)
@@ -188,6 +255,406 @@ void andBuffers(const uint8_t* __restrict buf1,
               & buf5[i] & buf6[i] & buf7[i] & buf8[i];
 }
 
+/// Same as above, but ANDs the 7 buffers
+/// into the already pre-sieved sieve array.
+///
+void andBuffers_default(const uint8_t* __restrict buf1,
+                        const uint8_t* __restrict buf2,
+                        const uint8_t* __restrict buf3,
+                        const uint8_t* __restrict buf4,
+                        const uint8_t* __restrict buf5,
+                        const uint8_t* __restrict buf6,
+                        const uint8_t* __restrict buf7,
+                        uint8_t* __restrict sieve,
+                        size_t bytes)
+{
+  // This loop should be auto-vectorized
+  for (size_t i = 0; i < bytes; i++)
+    sieve[i] &= buf1[i] & buf2[i] & buf3[i] & buf4[i]
+              & buf5[i] & buf6[i] & buf7[i];
+}
+
+#endif
+
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+void andBuffers_avx2(const uint8_t* __restrict buf1,
+                     const uint8_t* __restrict buf2,
+                     const uint8_t* __restrict buf3,
+                     const uint8_t* __restrict buf4,
+                     const uint8_t* __restrict buf5,
+                     const uint8_t* __restrict buf6,
+                     const uint8_t* __restrict buf7,
+                     const uint8_t* __restrict buf8,
+                     uint8_t* __restrict output,
+                     size_t bytes)
+{
+  size_t i = 0;
+
+  for (; i + sizeof(__m256i) <= bytes; i += sizeof(__m256i))
+  {
+    __m256i v1 = _mm256_loadu_si256((const __m256i*) &buf1[i]);
+    __m256i v2 = _mm256_loadu_si256((const __m256i*) &buf2[i]);
+    __m256i v3 = _mm256_loadu_si256((const __m256i*) &buf3[i]);
+    __m256i v4 = _mm256_loadu_si256((const __m256i*) &buf4[i]);
+    __m256i v5 = _mm256_loadu_si256((const __m256i*) &buf5[i]);
+    __m256i v6 = _mm256_loadu_si256((const __m256i*) &buf6[i]);
+    __m256i v7 = _mm256_loadu_si256((const __m256i*) &buf7[i]);
+    __m256i v8 = _mm256_loadu_si256((const __m256i*) &buf8[i]);
+
+    v1 = _mm256_and_si256(v1, v2);
+    v3 = _mm256_and_si256(v3, v4);
+    v5 = _mm256_and_si256(v5, v6);
+    v7 = _mm256_and_si256(v7, v8);
+    v1 = _mm256_and_si256(v1, v3);
+    v5 = _mm256_and_si256(v5, v7);
+    v1 = _mm256_and_si256(v1, v5);
+
+    _mm256_storeu_si256((__m256i*) &output[i], v1);
+  }
+
+  for (; i < bytes; i++)
+    output[i] = buf1[i] & buf2[i] & buf3[i] & buf4[i]
+              & buf5[i] & buf6[i] & buf7[i] & buf8[i];
+}
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+void andBuffers_avx2(const uint8_t* __restrict buf1,
+                     const uint8_t* __restrict buf2,
+                     const uint8_t* __restrict buf3,
+                     const uint8_t* __restrict buf4,
+                     const uint8_t* __restrict buf5,
+                     const uint8_t* __restrict buf6,
+                     const uint8_t* __restrict buf7,
+                     uint8_t* __restrict sieve,
+                     size_t bytes)
+{
+  size_t i = 0;
+
+  for (; i + sizeof(__m256i) <= bytes; i += sizeof(__m256i))
+  {
+    __m256i v1 = _mm256_loadu_si256((const __m256i*) &buf1[i]);
+    __m256i v2 = _mm256_loadu_si256((const __m256i*) &buf2[i]);
+    __m256i v3 = _mm256_loadu_si256((const __m256i*) &buf3[i]);
+    __m256i v4 = _mm256_loadu_si256((const __m256i*) &buf4[i]);
+    __m256i v5 = _mm256_loadu_si256((const __m256i*) &buf5[i]);
+    __m256i v6 = _mm256_loadu_si256((const __m256i*) &buf6[i]);
+    __m256i v7 = _mm256_loadu_si256((const __m256i*) &buf7[i]);
+    __m256i v8 = _mm256_loadu_si256((const __m256i*) &sieve[i]);
+
+    v1 = _mm256_and_si256(v1, v2);
+    v3 = _mm256_and_si256(v3, v4);
+    v5 = _mm256_and_si256(v5, v6);
+    v7 = _mm256_and_si256(v7, v8);
+    v1 = _mm256_and_si256(v1, v3);
+    v5 = _mm256_and_si256(v5, v7);
+    v1 = _mm256_and_si256(v1, v5);
+
+    _mm256_storeu_si256((__m256i*) &sieve[i], v1);
+  }
+
+  for (; i < bytes; i++)
+    sieve[i] &= buf1[i] & buf2[i] & buf3[i] & buf4[i]
+              & buf5[i] & buf6[i] & buf7[i];
+}
+
+#endif
+
+#if defined(ENABLE_AVX512_BW) || \
+    defined(ENABLE_MULTIARCH_AVX512_BW)
+
+#if defined(ENABLE_MULTIARCH_AVX512_BW)
+  __attribute__ ((target ("avx512f,avx512bw")))
+#endif
+void andBuffers_avx512(const uint8_t* __restrict buf1,
+                       const uint8_t* __restrict buf2,
+                       const uint8_t* __restrict buf3,
+                       const uint8_t* __restrict buf4,
+                       const uint8_t* __restrict buf5,
+                       const uint8_t* __restrict buf6,
+                       const uint8_t* __restrict buf7,
+                       const uint8_t* __restrict buf8,
+                       uint8_t* __restrict output,
+                       size_t bytes)
+{
+  size_t i = 0;
+
+  for (; i + sizeof(__m512i) <= bytes; i += sizeof(__m512i))
+  {
+    __m512i v1 = _mm512_loadu_si512((const __m512i*) &buf1[i]);
+    __m512i v2 = _mm512_loadu_si512((const __m512i*) &buf2[i]);
+    __m512i v3 = _mm512_loadu_si512((const __m512i*) &buf3[i]);
+    __m512i v4 = _mm512_loadu_si512((const __m512i*) &buf4[i]);
+    __m512i v5 = _mm512_loadu_si512((const __m512i*) &buf5[i]);
+    __m512i v6 = _mm512_loadu_si512((const __m512i*) &buf6[i]);
+    __m512i v7 = _mm512_loadu_si512((const __m512i*) &buf7[i]);
+    __m512i v8 = _mm512_loadu_si512((const __m512i*) &buf8[i]);
+
+    // 0x80 = bitwise AND of the 3 input vectors
+    v1 = _mm512_ternarylogic_epi64(v1, v2, v3, 0x80);
+    v4 = _mm512_ternarylogic_epi64(v4, v5, v6, 0x80);
+    v1 = _mm512_ternarylogic_epi64(v1, v4, v7, 0x80);
+    v1 = _mm512_and_si512(v1, v8);
+
+    _mm512_storeu_si512((__m512i*) &output[i], v1);
+  }
+
+  if (i < bytes)
+  {
+    __mmask64 mask = 0xffffffffffffffffull >> (i + sizeof(__m512i) - bytes);
+
+    __m512i v1 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf1[i]);
+    __m512i v2 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf2[i]);
+    __m512i v3 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf3[i]);
+    __m512i v4 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf4[i]);
+    __m512i v5 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf5[i]);
+    __m512i v6 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf6[i]);
+    __m512i v7 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf7[i]);
+    __m512i v8 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf8[i]);
+
+    v1 = _mm512_ternarylogic_epi64(v1, v2, v3, 0x80);
+    v4 = _mm512_ternarylogic_epi64(v4, v5, v6, 0x80);
+    v1 = _mm512_ternarylogic_epi64(v1, v4, v7, 0x80);
+    v1 = _mm512_and_si512(v1, v8);
+
+    _mm512_mask_storeu_epi8((__m512i*) &output[i], mask, v1);
+  }
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_BW)
+  __attribute__ ((target ("avx512f,avx512bw")))
+#endif
+void andBuffers_avx512(const uint8_t* __restrict buf1,
+                       const uint8_t* __restrict buf2,
+                       const uint8_t* __restrict buf3,
+                       const uint8_t* __restrict buf4,
+                       const uint8_t* __restrict buf5,
+                       const uint8_t* __restrict buf6,
+                       const uint8_t* __restrict buf7,
+                       uint8_t* __restrict sieve,
+                       size_t bytes)
+{
+  size_t i = 0;
+
+  for (; i + sizeof(__m512i) <= bytes; i += sizeof(__m512i))
+  {
+    __m512i v1 = _mm512_loadu_si512((const __m512i*) &buf1[i]);
+    __m512i v2 = _mm512_loadu_si512((const __m512i*) &buf2[i]);
+    __m512i v3 = _mm512_loadu_si512((const __m512i*) &buf3[i]);
+    __m512i v4 = _mm512_loadu_si512((const __m512i*) &buf4[i]);
+    __m512i v5 = _mm512_loadu_si512((const __m512i*) &buf5[i]);
+    __m512i v6 = _mm512_loadu_si512((const __m512i*) &buf6[i]);
+    __m512i v7 = _mm512_loadu_si512((const __m512i*) &buf7[i]);
+    __m512i v8 = _mm512_loadu_si512((const __m512i*) &sieve[i]);
+
+    v1 = _mm512_ternarylogic_epi64(v1, v2, v3, 0x80);
+    v4 = _mm512_ternarylogic_epi64(v4, v5, v6, 0x80);
+    v1 = _mm512_ternarylogic_epi64(v1, v4, v7, 0x80);
+    v1 = _mm512_and_si512(v1, v8);
+
+    _mm512_storeu_si512((__m512i*) &sieve[i], v1);
+  }
+
+  if (i < bytes)
+  {
+    __mmask64 mask = 0xffffffffffffffffull >> (i + sizeof(__m512i) - bytes);
+
+    __m512i v1 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf1[i]);
+    __m512i v2 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf2[i]);
+    __m512i v3 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf3[i]);
+    __m512i v4 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf4[i]);
+    __m512i v5 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf5[i]);
+    __m512i v6 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf6[i]);
+    __m512i v7 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &buf7[i]);
+    __m512i v8 = _mm512_maskz_loadu_epi8(mask, (const __m512i*) &sieve[i]);
+
+    v1 = _mm512_ternarylogic_epi64(v1, v2, v3, 0x80);
+    v4 = _mm512_ternarylogic_epi64(v4, v5, v6, 0x80);
+    v1 = _mm512_ternarylogic_epi64(v1, v4, v7, 0x80);
+    v1 = _mm512_and_si512(v1, v8);
+
+    _mm512_mask_storeu_epi8((__m512i*) &sieve[i], mask, v1);
+  }
+}
+
+#endif
+
+/// Bitwise AND of the 8 tier 1 pre-sieve buffers. Uses
+/// the widest vector instruction set supported by the CPU.
+///
+void andBuffers(const std::array<const uint8_t*, 8>& buf,
+                uint8_t* output,
+                size_t bytes)
+{
+#if defined(ENABLE_AVX512_BW)
+  andBuffers_avx512(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7], output, bytes);
+#elif defined(ENABLE_AVX2)
+  andBuffers_avx2(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7], output, bytes);
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    if (cpu_supports_avx512_bw)
+    {
+      andBuffers_avx512(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7], output, bytes);
+      return;
+    }
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+    {
+      andBuffers_avx2(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7], output, bytes);
+      return;
+    }
+  #endif
+
+  andBuffers_default(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7], output, bytes);
+#endif
+}
+
+/// Bitwise AND of the 7 tier 2 pre-sieve buffers
+/// and the (tier 1 pre-sieved) sieve array.
+///
+void andBuffers(const std::array<const uint8_t*, 7>& buf,
+                uint8_t* sieve,
+                size_t bytes)
+{
+#if defined(ENABLE_AVX512_BW)
+  andBuffers_avx512(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], sieve, bytes);
+#elif defined(ENABLE_AVX2)
+  andBuffers_avx2(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], sieve, bytes);
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    if (cpu_supports_avx512_bw)
+    {
+      andBuffers_avx512(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], sieve, bytes);
+      return;
+    }
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+    {
+      andBuffers_avx2(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], sieve, bytes);
+      return;
+    }
+  #endif
+
+  andBuffers_default(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], sieve, bytes);
+#endif
+}
+
+/// Remove the multiples of the primes of bufferPrimes[i]
+/// from buffers[i]. Returns the largest pre-sieved prime.
+///
+template <std::size_t N>
+uint64_t initBufferGroup(std::array<std::vector<uint8_t>, N>& buffers,
+                         const std::array<std::vector<uint64_t>, N>& bufferPrimes)
+{
+  uint64_t maxPrime = 0;
+
+  for (size_t i = 0; i < buffers.size(); i++)
+  {
+    uint64_t product = 30;
+
+    for (uint64_t prime : bufferPrimes[i])
+      product *= prime;
+
+    uint64_t start = product;
+    uint64_t stop = start + product;
+    buffers[i].resize(product / 30, 0xff);
+    uint64_t maxBufferPrime = bufferPrimes[i].back();
+    assert(maxBufferPrime == *std::max_element(bufferPrimes[i].begin(), bufferPrimes[i].end()));
+    assert(start >= maxBufferPrime * maxBufferPrime);
+    maxPrime = std::max(maxPrime, maxBufferPrime);
+
+    primesieve::EratSmall eratSmall;
+    eratSmall.init(stop, buffers[i].size(), maxBufferPrime);
+
+    for (uint64_t prime : bufferPrimes[i])
+      eratSmall.addSievingPrime(prime, start);
+
+    eratSmall.crossOff(buffers[i].data(), buffers[i].size());
+  }
+
+  return maxPrime;
+}
+
+/// AND the pre-sieve buffers into the sieve array. Each
+/// buffer is periodic, buffers[i][pos] corresponds to the
+/// integers segmentLow + (pos * 30) modulo its period.
+///
+template <std::size_t N>
+void preSieveBuffers(const std::array<std::vector<uint8_t>, N>& buffers,
+                     uint8_t* sieve,
+                     uint64_t sieveSize,
+                     uint64_t segmentLow)
+{
+  uint64_t offset = 0;
+  std::array<uint64_t, N> pos;
+  std::array<const uint8_t*, N> buf;
+
+  for (size_t i = 0; i < buffers.size(); i++)
+    pos[i] = (segmentLow % (buffers[i].size() * 30)) / 30;
+
+  while (offset < sieveSize)
+  {
+    uint64_t bytesToCopy = sieveSize - offset;
+
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      uint64_t left = buffers[i].size() - pos[i];
+      bytesToCopy = std::min(left, bytesToCopy);
+      buf[i] = &buffers[i][pos[i]];
+    }
+
+    andBuffers(buf, &sieve[offset], bytesToCopy);
+    offset += bytesToCopy;
+
+    for (size_t i = 0; i < pos.size(); i++)
+    {
+      pos[i] += bytesToCopy;
+      if (pos[i] >= buffers[i].size())
+        pos[i] = 0;
+    }
+  }
+}
+
+/// Pre-sieve buffers use 1 byte per 30 integers
+uint64_t buffersBytes(int tier)
+{
+  uint64_t bytes = 0;
+
+  if (tier >= 1)
+    bytes += buffersDist / 30;
+  if (tier >= 2)
+    bytes += buffersDistTier2 / 30;
+
+  return bytes;
+}
+
+/// Tier 2 pre-sieving is only worth it if all pre-sieve
+/// buffers and the sieve array fit into the CPU's L2 cache.
+/// By default the sieve array uses at most half of the L2
+/// cache (see get_sieve_size() in api.cpp).
+///
+bool fitsL2Cache(int tier)
+{
+  if (!cpuInfo.hasL2Cache())
+    return false;
+
+  uint64_t l2CacheSize = cpuInfo.l2CacheBytes();
+
+  if (cpuInfo.hasL2Sharing() &&
+      cpuInfo.l2Sharing() > 1)
+    l2CacheSize /= cpuInfo.l2Sharing();
+
+  return buffersBytes(tier) <= l2CacheSize / 2;
+}
+
 } // namespace
 
 namespace primesieve {
@@ -195,10 +662,6 @@ namespace primesieve {
 void PreSieve::init(uint64_t start,
                     uint64_t stop)
 {
-  // Already initialized
-  if (!buffers_[0].empty())
-    return;
-
   // The pre-sieve buffers should be at least 20
   // times smaller than the sieving distance
   // in order to reduce initialization overhead.
@@ -211,36 +674,34 @@ void PreSieve::init(uint64_t start,
   if (threshold < buffersDist * 20)
     return;
 
-  initBuffers();
+  // Tier 2 pays off after sieving a few million integers
+  // (see bench/presieve.cpp), so whenever it is worth
+  // initializing tier 1 it is also worth initializing
+  // tier 2, provided that its buffers fit into the cache.
+  int tier = 1;
+
+  if (config::PRESIEVE_MAX_TIER >= 2 &&
+      fitsL2Cache(2))
+    tier = 2;
+
+  initBuffers(tier);
 }
 
-/// We are sieving a large interval, we have to
-/// initialize all pre-sieve buffers.
+/// Initialize the pre-sieve buffers of all tiers <= tier.
+/// Tiers that have already been initialized are skipped.
 ///
-void PreSieve::initBuffers()
+void PreSieve::initBuffers(int tier)
 {
-  for (size_t i = 0; i < buffers_.size(); i++)
+  if (tier >= 1 && buffers_[0].empty())
   {
-    uint64_t product = 30;
-
-    for (uint64_t prime : bufferPrimes[i])
-      product *= prime;
-
-    uint64_t start = product;
-    uint64_t stop = start + product;
-    buffers_[i].resize(product / 30, 0xff);
-    uint64_t maxPrime = bufferPrimes[i].back();
-    assert(maxPrime == *std::max_element(bufferPrimes[i].begin(), bufferPrimes[i].end()));
-    assert(start >= maxPrime * maxPrime);
+    uint64_t maxPrime = initBufferGroup(buffers_, bufferPrimes);
     maxPrime_ = std::max(maxPrime_, maxPrime);
+  }
 
-    EratSmall eratSmall;
-    eratSmall.init(stop, buffers_[i].size(), maxPrime);
-
-    for (uint64_t prime : bufferPrimes[i])
-      eratSmall.addSievingPrime(prime, start);
-
-    eratSmall.crossOff(buffers_[i].data(), buffers_[i].size());
+  if (tier >= 2 && buffersTier2_[0].empty())
+  {
+    uint64_t maxPrime = initBufferGroup(buffersTier2_, bufferPrimesTier2);
+    maxPrime_ = std::max(maxPrime_, maxPrime);
   }
 }
 
@@ -253,14 +714,18 @@ void PreSieve::preSieve(uint8_t* sieve,
   else
     preSieveLarge(sieve, sieveSize, segmentLow);
 
-  // Pre-sieving removes the primes < 100. We
-  // have to undo that work and reset these bits
+  // Pre-sieving removes the primes <= maxPrime_.
+  // We have to undo that work and reset these bits
   // to 1 (but 49 = 7 * 7 is not a prime).
   uint8_t bit49 = 1 << 4;
   uint8_t bit77 = 1 << 3;
   uint8_t bit91 = 1 << 7;
   uint8_t bit119 = 1 << 6;
   uint8_t bit121 = 1 << 7;
+  uint8_t bit133 = 1 << 2;
+  uint8_t bit143 = 1 << 5;
+  uint8_t bit161 = 1 << 1;
+  uint8_t bit169 = 1 << 4;
 
   size_t i = 0;
 
@@ -272,6 +737,10 @@ void PreSieve::preSieve(uint8_t* sieve,
     sieve[i++] = 0xff ^ bit77 ^ bit91;
   if (segmentLow < 120)
     sieve[i++] = 0xff ^ bit119 ^ bit121;
+  if (segmentLow < 150)
+    sieve[i++] = 0xff ^ bit133 ^ bit143;
+  if (segmentLow < 180)
+    sieve[i++] = 0xff ^ bit161 ^ bit169;
 }
 
 /// Pre-sieve with the primes <= 13
@@ -302,42 +771,27 @@ void PreSieve::preSieveSmall(uint8_t* sieve,
   }
 }
 
-/// Pre-sieve with the primes < 100
+/// Pre-sieve with the primes < 100 (tier 1)
+/// and optionally with the primes <= 167 (tier 2).
+///
 void PreSieve::preSieveLarge(uint8_t* sieve,
                              uint64_t sieveSize,
                              uint64_t segmentLow) const
 {
-  uint64_t offset = 0;
-  std::array<uint64_t, 8> pos;
-
-  for (size_t i = 0; i < buffers_.size(); i++)
-    pos[i] = (segmentLow % (buffers_[i].size() * 30)) / 30;
-
-  while (offset < sieveSize) {
-    uint64_t bytesToCopy = sieveSize - offset;
-
-    for (size_t i = 0; i < buffers_.size(); i++) {
-      uint64_t left = buffers_[i].size() - pos[i];
-      bytesToCopy = std::min(left, bytesToCopy);
-    }
-
-    andBuffers(&buffers_[0][pos[0]],
-               &buffers_[1][pos[1]],
-               &buffers_[2][pos[2]],
-               &buffers_[3][pos[3]],
-               &buffers_[4][pos[4]],
-               &buffers_[5][pos[5]],
-               &buffers_[6][pos[6]],
-               &buffers_[7][pos[7]],
-               &sieve[offset],
-               bytesToCopy);
-
-    offset += bytesToCopy;
-
-    for (size_t i = 0; i < pos.size(); i++) {
-      pos[i] += bytesToCopy;
-      if (pos[i] >= buffers_[i].size())
-        pos[i] = 0;
+  if (buffersTier2_[0].empty())
+    preSieveBuffers(buffers_, sieve, sieveSize, segmentLow);
+  else
+  {
+    // Pre-sieve in small chunks so that the tier 2
+    // pass reads the sieve array from the L1 cache.
+    uint64_t chunkSize = 16 << 10;
+
+    for (uint64_t i = 0; i < sieveSize; i += chunkSize)
+    {
+      uint64_t low = segmentLow + i * 30;
+      uint64_t size = std::min(chunkSize, sieveSize - i);
+      preSieveBuffers(buffers_, &sieve[i], size, low);
+      preSieveBuffers(buffersTier2_, &sieve[i], size, low);
     }
   }
 }
@@ -20,6 +20,7 @@
 #include <primesieve/Erat.hpp>
 #include <primesieve/forward.hpp>
 #include <primesieve/littleendian_cast.hpp>
+#include <primesieve/macros.hpp>
 #include <primesieve/PreSieve.hpp>
 #include <primesieve/PrimeGenerator.hpp>
 #include <primesieve/pmath.hpp>
@@ -34,14 +35,34 @@
 #include <vector>
 
 /// Enable AVX512 if primesieve is compiled using e.g.
-/// -march=native on an AVX512 capable CPU.
+/// -march=native on an AVX512 capable CPU. Otherwise
+/// we dispatch at runtime to the AVX512 or AVX2 code path
+/// if the CPU supports it (see cmake/multiarch_*.cmake).
 #if !defined(DISABLE_AVX512) && \
      defined(__AVX512F__) && \
      defined(__AVX512BW__) && \
+     defined(__AVX512VBMI__) && \
      defined(__AVX512VBMI2__) && \
      __has_include(<immintrin.h>)
-  #define ENABLE_AVX512
   #include <immintrin.h>
+  #define ENABLE_AVX512_VBMI2
+
+#elif defined(__AVX2__) && \
+      __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX2
+
+#elif (defined(ENABLE_MULTIARCH_AVX512_VBMI2) || \
+       defined(ENABLE_MULTIARCH_AVX2)) && \
+       __has_include(<immintrin.h>)
+  #include <immintrin.h>
+
+  #if defined(ENABLE_MULTIARCH_AVX512_VBMI2)
+    #include <primesieve/cpu_supports_avx512_vbmi2.hpp>
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    #include <primesieve/cpu_supports_avx2.hpp>
+  #endif
 #endif
 
 using std::size_t;
@@ -66,6 +87,42 @@ const std::array<uint64_t, 128> smallPrimes =
   661, 673, 677, 683, 691, 701, 709, 719
 };
 
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+/// Offsets of the 1 bits of a sieve byte (packed
+/// into 8 bytes) and the number of 1 bits.
+struct ByteOffsets
+{
+  uint64_t offsets;
+  uint64_t count;
+};
+
+std::array<ByteOffsets, 256> initByteOffsets()
+{
+  std::array<ByteOffsets, 256> byteOffsets;
+
+  for (uint64_t b = 0; b < 256; b++)
+  {
+    byteOffsets[b] = ByteOffsets{0, 0};
+    for (uint64_t i = 0; i < 8; i++)
+    {
+      if (b & (1ull << i))
+      {
+        uint64_t shift = byteOffsets[b].count * 8;
+        byteOffsets[b].offsets |= primesieve::bitValues[i] << shift;
+        byteOffsets[b].count += 1;
+      }
+    }
+  }
+
+  return byteOffsets;
+}
+
+const std::array<ByteOffsets, 256> byteOffsets = initByteOffsets();
+
+#endif
+
 /// Number of primes <= n
 const std::array<uint8_t, 720> primePi =
 {
@@ -221,7 +278,7 @@ void PrimeGenerator::initErat()
   if (startErat <= stop_)
   {
     int sieveSize = get_sieve_size();
-    Erat::init(startErat, stop_, sieveSize, preSieve_, memoryPool_);
+    Erat::init(startErat, stop_, sieveSize, preSieve_, memoryPool_, primesieve::getTuneSettings());
     sievingPrimes_.init(this, preSieve_, memoryPool_);
   }
 }
@@ -298,52 +355,201 @@ bool PrimeGenerator::sieveNextPrimes(std::vector<uint64_t>& primes,
 /// over the primes inside [a, b] we need to generate new
 /// primes which incurs an initialization overhead of O(sqrt(n)).
 ///
+/// Before decoding a segment we count its primes (popcount)
+/// and resize the primes vector once. Hence the decoding
+/// algorithms never run out of space and decode the entire
+/// segment using the same code as fillNextPrimes().
+///
 void PrimeGenerator::fillPrevPrimes(std::vector<uint64_t>& primes,
                                     size_t* size)
 {
   while (sievePrevPrimes(primes, size))
   {
-    // Use local variables to prevent the compiler from
-    // writing temporary results to memory.
-    size_t i = *size;
-    uint64_t low = low_;
-    uint64_t sieveIdx = sieveIdx_;
-    uint64_t sieveSize = sieveSize_;
-    uint8_t* sieve = sieve_;
-
-    while (sieveIdx < sieveSize)
+    // The sieve array is padded with zeros to
+    // the next multiple of 8 bytes.
+    uint64_t words = ceilDiv(sieveSize_, 8);
+    uint64_t count = popcount((const uint64_t*) sieve_, words);
+
+    // Each loop iteration of the decoding algorithms
+    // can write up to 64 elements of the primes vector.
+    size_t maxSize = *size + count + 64;
+    if (primes.size() < maxSize)
+      resizeUninitialized(primes, maxSize);
+
+    fillPrimes(primes, size);
+    assert(sieveIdx_ >= sieveSize_);
+  }
+}
+
+/// This method is used by iterator::next_prime().
+/// This method stores only the next few primes (~ 200) in the
+/// primes vector. Also for iterator::next_prime() there is no
+/// recurring initialization overhead (unlike prev_prime()) for
+/// this reason iterator::next_prime() runs up to 2x faster
+/// than iterator::prev_prime().
+///
+void PrimeGenerator::fillNextPrimes(std::vector<uint64_t>& primes,
+                                    size_t* size)
+{
+  do
+  {
+    if (sieveIdx_ >= sieveSize_)
+      if (!sieveNextPrimes(primes, size))
+        return;
+
+    fillPrimes(primes, size);
+  }
+  while (*size == 0);
+}
+
+/// Convert the 1 bits of the sieve array into primes and
+/// store them in primes[*size], primes[*size + 1], ... until
+/// the end of the sieve array or until there is not enough
+/// space left in the primes vector for 64 more primes.
+/// The primes are decoded using the widest vector instruction
+/// set supported by the CPU (AVX512 VBMI2, AVX2 or portable
+/// CTZ code).
+///
+void PrimeGenerator::fillPrimes(std::vector<uint64_t>& primes,
+                                size_t* size)
+{
+#if defined(ENABLE_AVX512_VBMI2)
+  fillPrimes_avx512(primes, size);
+#elif defined(ENABLE_AVX2)
+  fillPrimes_avx2(primes, size);
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_VBMI2)
+    if (cpu_supports_avx512_vbmi2)
+      fillPrimes_avx512(primes, size);
+    else
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+      fillPrimes_avx2(primes, size);
+    else
+  #endif
+    fillPrimes_default(primes, size);
+#endif
+}
+
+/// Portable algorithm, converts the 1 bits of the
+/// sieve array into primes using CTZ (count trailing
+/// zeros).
+///
+void PrimeGenerator::fillPrimes_default(std::vector<uint64_t>& primes,
+                                        size_t* size)
+{
+  // Use local variables to prevent the compiler from
+  // writing temporary results to memory.
+  size_t i = *size;
+  size_t maxSize = primes.size();
+  assert(maxSize >= 64);
+  uint64_t low = low_;
+  uint64_t sieveIdx = sieveIdx_;
+  uint64_t sieveSize = sieveSize_;
+  uint8_t* sieve = sieve_;
+
+  // Each loop iteration can generate up to 64 primes
+  // so we have to stop generating primes once there is
+  // not enough space for 64 more primes.
+  do
+  {
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve[sieveIdx]);
+    size_t j = i;
+    i += popcnt64(bits);
+
+    do
     {
-      // Each loop iteration can generate up to 64 primes,
-      // so we have to make sure there is enough space
-      // left in the primes vector.
-      if (i + 64 > primes.size())
-        resizeUninitialized(primes, i + 64);
+      assert(j + 4 < maxSize);
+      primes[j+0] = nextPrime(bits, low); bits &= bits - 1;
+      primes[j+1] = nextPrime(bits, low); bits &= bits - 1;
+      primes[j+2] = nextPrime(bits, low); bits &= bits - 1;
+      primes[j+3] = nextPrime(bits, low); bits &= bits - 1;
+      j += 4;
+    }
+    while (j < i);
+
+    low += 8 * 30;
+    sieveIdx += 8;
+  }
+  while (i <= maxSize - 64 &&
+         sieveIdx < sieveSize);
 
-      uint64_t bits = littleendian_cast<uint64_t>(&sieve[sieveIdx]);
-      size_t j = i;
-      i += popcnt64(bits);
+  low_ = low;
+  sieveIdx_ = sieveIdx;
+  *size = i;
+}
 
-      do
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+/// This algorithm converts 1 bits from the sieve array into
+/// primes using AVX2. Each sieve byte is looked up in the
+/// byteOffsets table which contains the offsets of its 1 bits
+/// (packed into 8 bytes) and the number of 1 bits. The first 4
+/// offsets are zero extended to 64-bit and added to the low
+/// number of the sieve byte using a single vector addition,
+/// only sieve bytes with more than 4 primes require a second
+/// vector addition. Unlike the CTZ algorithm this algorithm
+/// has no data dependent loop and hence no branch
+/// mispredictions for the most common sieve bytes.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+void PrimeGenerator::fillPrimes_avx2(std::vector<uint64_t>& primes,
+                                     size_t* size)
+{
+  size_t i = *size;
+  size_t maxSize = primes.size();
+  assert(maxSize >= 64);
+  uint64_t low = low_;
+  uint64_t sieveIdx = sieveIdx_;
+  uint64_t sieveSize = sieveSize_;
+  uint8_t* sieve = sieve_;
+  uint64_t* primes64 = primes.data();
+  __m256i step = _mm256_set1_epi64x(30);
+
+  // Each loop iteration can generate up to 64 primes
+  // and writes up to 64 elements of the primes vector.
+  do
+  {
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve[sieveIdx]);
+    __m256i base = _mm256_set1_epi64x((int64_t) low);
+
+    for (int j = 0; j < 8; j++)
+    {
+      const ByteOffsets& byte = byteOffsets[(bits >> (j * 8)) & 0xff];
+      __m128i offsets = _mm_cvtsi64_si128((int64_t) byte.offsets);
+      __m256i vprimes = _mm256_add_epi64(base, _mm256_cvtepu8_epi64(offsets));
+      _mm256_storeu_si256((__m256i*) &primes64[i], vprimes);
+
+      if_unlikely(byte.count > 4)
       {
-        primes[j+0] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+1] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+2] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+3] = nextPrime(bits, low); bits &= bits - 1;
-        j += 4;
+        offsets = _mm_srli_si128(offsets, 4);
+        vprimes = _mm256_add_epi64(base, _mm256_cvtepu8_epi64(offsets));
+        _mm256_storeu_si256((__m256i*) &primes64[i + 4], vprimes);
       }
-      while (j < i);
 
-      low += 8 * 30;
-      sieveIdx += 8;
+      i += byte.count;
+      base = _mm256_add_epi64(base, step);
     }
 
-    low_ = low;
-    sieveIdx_ = sieveIdx;
-    *size = i;
+    low += 8 * 30;
+    sieveIdx += 8;
   }
+  while (i <= maxSize - 64 &&
+         sieveIdx < sieveSize);
+
+  low_ = low;
+  sieveIdx_ = sieveIdx;
+  *size = i;
 }
 
-#if defined(ENABLE_AVX512)
+#endif
+
+#if defined(ENABLE_AVX512_VBMI2) || \
+    defined(ENABLE_MULTIARCH_AVX512_VBMI2)
 
 /// This algorithm converts 1 bits from the sieve array into primes
 /// using AVX512. The algorithm is a modified version of the AVX512
@@ -356,197 +562,129 @@ void PrimeGenerator::fillPrevPrimes(std::vector<uint64_t>& primes,
 /// from the sieve array there are if checks that skip to the next
 /// loop iteration once all 1 bits have been processed. In my
 /// benchmarks this algorithm ran about 5% faster than the default
-/// fillNextPrimes() algorithm which uses __builtin_ctzll().
+/// fillPrimes_default() algorithm which uses __builtin_ctzll().
 ///
-void PrimeGenerator::fillNextPrimes(std::vector<uint64_t>& primes,
-                                    size_t* size)
+#if defined(ENABLE_MULTIARCH_AVX512_VBMI2)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vbmi,avx512vbmi2,popcnt")))
+#endif
+void PrimeGenerator::fillPrimes_avx512(std::vector<uint64_t>& primes,
+                                       size_t* size)
 {
-  do
+  uint64_t maxSize = primes.size();
+  assert(primes.size() >= 64);
+
+  __m512i avxBitValues = _mm512_set_epi8(
+    (char) 241, (char) 239, (char) 233, (char) 229,
+    (char) 227, (char) 223, (char) 221, (char) 217,
+    (char) 211, (char) 209, (char) 203, (char) 199,
+    (char) 197, (char) 193, (char) 191, (char) 187,
+    (char) 181, (char) 179, (char) 173, (char) 169,
+    (char) 167, (char) 163, (char) 161, (char) 157,
+    (char) 151, (char) 149, (char) 143, (char) 139,
+    (char) 137, (char) 133, (char) 131, (char) 127,
+    (char) 121, (char) 119, (char) 113, (char) 109,
+    (char) 107, (char) 103, (char) 101, (char)  97,
+    (char)  91, (char)  89, (char)  83, (char)  79,
+    (char)  77, (char)  73, (char)  71, (char)  67,
+    (char)  61, (char)  59, (char)  53, (char)  49,
+    (char)  47, (char)  43, (char)  41, (char)  37,
+    (char)  31, (char)  29, (char)  23, (char)  19,
+    (char)  17, (char)  13, (char)  11, (char)   7
+  );
+
+  __m512i bytes_0_to_7   = _mm512_setr_epi64( 0,  1,  2,  3,  4,  5,  6,  7);
+  __m512i bytes_8_to_15  = _mm512_setr_epi64( 8,  9, 10, 11, 12, 13, 14, 15);
+  __m512i bytes_16_to_23 = _mm512_setr_epi64(16, 17, 18, 19, 20, 21, 22, 23);
+  __m512i bytes_24_to_31 = _mm512_setr_epi64(24, 25, 26, 27, 28, 29, 30, 31);
+  __m512i bytes_32_to_39 = _mm512_setr_epi64(32, 33, 34, 35, 36, 37, 38, 39);
+  __m512i bytes_40_to_47 = _mm512_setr_epi64(40, 41, 42, 43, 44, 45, 46, 47);
+  __m512i bytes_48_to_55 = _mm512_setr_epi64(48, 49, 50, 51, 52, 53, 54, 55);
+  __m512i bytes_56_to_63 = _mm512_setr_epi64(56, 57, 58, 59, 60, 61, 62, 63);
+
+  while (sieveIdx_ < sieveSize_)
   {
-    if (sieveIdx_ >= sieveSize_)
-      if (!sieveNextPrimes(primes, size))
-        return;
+    // Each iteration processes 8 bytes from the sieve array
+    uint64_t bits64 = *(uint64_t*) &sieve_[sieveIdx_];
+    uint64_t primeCount = popcnt64(bits64);
 
-    *size = 0;
-    uint64_t maxSize = primes.size();
-    assert(primes.size() >= 64);
-
-    __m512i avxBitValues = _mm512_set_epi8(
-      (char) 241, (char) 239, (char) 233, (char) 229,
-      (char) 227, (char) 223, (char) 221, (char) 217,
-      (char) 211, (char) 209, (char) 203, (char) 199,
-      (char) 197, (char) 193, (char) 191, (char) 187,
-      (char) 181, (char) 179, (char) 173, (char) 169,
-      (char) 167, (char) 163, (char) 161, (char) 157,
-      (char) 151, (char) 149, (char) 143, (char) 139,
-      (char) 137, (char) 133, (char) 131, (char) 127,
-      (char) 121, (char) 119, (char) 113, (char) 109,
-      (char) 107, (char) 103, (char) 101, (char)  97,
-      (char)  91, (char)  89, (char)  83, (char)  79,
-      (char)  77, (char)  73, (char)  71, (char)  67,
-      (char)  61, (char)  59, (char)  53, (char)  49,
-      (char)  47, (char)  43, (char)  41, (char)  37,
-      (char)  31, (char)  29, (char)  23, (char)  19,
-      (char)  17, (char)  13, (char)  11, (char)   7
-    );
-
-    __m512i bytes_0_to_7   = _mm512_setr_epi64( 0,  1,  2,  3,  4,  5,  6,  7);
-    __m512i bytes_8_to_15  = _mm512_setr_epi64( 8,  9, 10, 11, 12, 13, 14, 15);
-    __m512i bytes_16_to_23 = _mm512_setr_epi64(16, 17, 18, 19, 20, 21, 22, 23);
-    __m512i bytes_24_to_31 = _mm512_setr_epi64(24, 25, 26, 27, 28, 29, 30, 31);
-    __m512i bytes_32_to_39 = _mm512_setr_epi64(32, 33, 34, 35, 36, 37, 38, 39);
-    __m512i bytes_40_to_47 = _mm512_setr_epi64(40, 41, 42, 43, 44, 45, 46, 47);
-    __m512i bytes_48_to_55 = _mm512_setr_epi64(48, 49, 50, 51, 52, 53, 54, 55);
-    __m512i bytes_56_to_63 = _mm512_setr_epi64(56, 57, 58, 59, 60, 61, 62, 63);
-
-    while (sieveIdx_ < sieveSize_)
-    {
-      // Each iteration processes 8 bytes from the sieve array
-      uint64_t bits64 = *(uint64_t*) &sieve_[sieveIdx_];
-      uint64_t primeCount = popcnt64(bits64);
+    // Prevent _mm512_storeu_si512() buffer overrun
+    if (*size + primeCount + (8 - primeCount % 8) >= maxSize)
+      break;
 
-      // Prevent _mm512_storeu_si512() buffer overrun
-      if (*size + primeCount + (8 - primeCount % 8) >= maxSize)
-        break;
+    __m512i base = _mm512_set1_epi64(low_);
+    uint64_t* primes64 = &primes[*size];
 
-      __m512i base = _mm512_set1_epi64(low_);
-      uint64_t* primes64 = &primes[*size];
+    // These variables are not used anymore during this
+    // iteration, increment for next iteration.
+    *size += primeCount;
+    low_ += 8 * 30;
+    sieveIdx_ += 8;
 
-      // These variables are not used anymore during this
-      // iteration, increment for next iteration.
-      *size += primeCount;
-      low_ += 8 * 30;
-      sieveIdx_ += 8;
+    // Convert 1-bits to 0xff bytes
+    __m512i bytes64 = _mm512_maskz_set1_epi8(bits64, (char) 0xff);
 
-      // Convert 1-bits to 0xff bytes
-      __m512i bytes64 = _mm512_maskz_set1_epi8(bits64, (char) 0xff);
+    // Convert 0xff bytes into prime number offsets
+    // using the avxBitValues lookup table.
+    __m512i primeOffsets = _mm512_and_si512(bytes64, avxBitValues);
 
-      // Convert 0xff bytes into prime number offsets
-      // using the avxBitValues lookup table.
-      __m512i primeOffsets = _mm512_and_si512(bytes64, avxBitValues);
+    // Move all non zero bytes (prime offsets) to the beginning
+    primeOffsets = _mm512_maskz_compress_epi8(bits64, primeOffsets);
 
-      // Move all non zero bytes (prime offsets) to the beginning
-      primeOffsets = _mm512_maskz_compress_epi8(bits64, primeOffsets);
+    // Convert the first 8 bytes (prime offsets)
+    // into eight 64-bit prime numbers.
+    __m512i vprimes0 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_0_to_7, primeOffsets);
+    vprimes0 = _mm512_add_epi64(base, vprimes0);
+    _mm512_storeu_si512(&primes64[0], vprimes0);
 
-      // Convert the first 8 bytes (prime offsets)
-      // into eight 64-bit prime numbers.
-      __m512i vprimes0 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_0_to_7, primeOffsets);
-      vprimes0 = _mm512_add_epi64(base, vprimes0);
-      _mm512_storeu_si512(&primes64[0], vprimes0);
+    if (primeCount <= 8)
+      continue;
 
-      if (primeCount <= 8)
-        continue;
+    __m512i vprimes1 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_8_to_15, primeOffsets);
+    vprimes1 = _mm512_add_epi64(base, vprimes1);
+    _mm512_storeu_si512(&primes64[8], vprimes1);
 
-      __m512i vprimes1 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_8_to_15, primeOffsets);
-      vprimes1 = _mm512_add_epi64(base, vprimes1);
-      _mm512_storeu_si512(&primes64[8], vprimes1);
+    if (primeCount <= 16)
+      continue;
 
-      if (primeCount <= 16)
-        continue;
+    __m512i vprimes2 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_16_to_23, primeOffsets);
+    vprimes2 = _mm512_add_epi64(base, vprimes2);
+    _mm512_storeu_si512(&primes64[16], vprimes2);
 
-      __m512i vprimes2 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_16_to_23, primeOffsets);
-      vprimes2 = _mm512_add_epi64(base, vprimes2);
-      _mm512_storeu_si512(&primes64[16], vprimes2);
+    if (primeCount <= 24)
+      continue;
 
-      if (primeCount <= 24)
-        continue;
+    __m512i vprimes3 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_24_to_31, primeOffsets);
+    vprimes3 = _mm512_add_epi64(base, vprimes3);
+    _mm512_storeu_si512(&primes64[24], vprimes3);
 
-      __m512i vprimes3 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_24_to_31, primeOffsets);
-      vprimes3 = _mm512_add_epi64(base, vprimes3);
-      _mm512_storeu_si512(&primes64[24], vprimes3);
+    if (primeCount <= 32)
+      continue;
 
-      if (primeCount <= 32)
-        continue;
+    __m512i vprimes4 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_32_to_39, primeOffsets);
+    vprimes4 = _mm512_add_epi64(base, vprimes4);
+    _mm512_storeu_si512(&primes64[32], vprimes4);
 
-      __m512i vprimes4 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_32_to_39, primeOffsets);
-      vprimes4 = _mm512_add_epi64(base, vprimes4);
-      _mm512_storeu_si512(&primes64[32], vprimes4);
+    if (primeCount <= 40)
+      continue;
 
-      if (primeCount <= 40)
-        continue;
+    __m512i vprimes5 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_40_to_47, primeOffsets);
+    vprimes5 = _mm512_add_epi64(base, vprimes5);
+    _mm512_storeu_si512(&primes64[40], vprimes5);
 
-      __m512i vprimes5 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_40_to_47, primeOffsets);
-      vprimes5 = _mm512_add_epi64(base, vprimes5);
-      _mm512_storeu_si512(&primes64[40], vprimes5);
+    if (primeCount <= 48)
+      continue;
 
-      if (primeCount <= 48)
-        continue;
+    __m512i vprimes6 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_48_to_55, primeOffsets);
+    vprimes6 = _mm512_add_epi64(base, vprimes6);
+    _mm512_storeu_si512(&primes64[48], vprimes6);
 
-      __m512i vprimes6 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_48_to_55, primeOffsets);
-      vprimes6 = _mm512_add_epi64(base, vprimes6);
-      _mm512_storeu_si512(&primes64[48], vprimes6);
+    if (primeCount <= 56)
+      continue;
 
-      if (primeCount <= 56)
-        continue;
-
-      __m512i vprimes7 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_56_to_63, primeOffsets);
-      vprimes7 = _mm512_add_epi64(base, vprimes7);
-      _mm512_storeu_si512(&primes64[56], vprimes7);
-    }
+    __m512i vprimes7 = _mm512_maskz_permutexvar_epi8(0x0101010101010101ull, bytes_56_to_63, primeOffsets);
+    vprimes7 = _mm512_add_epi64(base, vprimes7);
+    _mm512_storeu_si512(&primes64[56], vprimes7);
   }
-  while (*size == 0);
-}
-
-#else
-
-/// This method is used by iterator::next_prime().
-/// This method stores only the next few primes (~ 200) in the
-/// primes vector. Also for iterator::next_prime() there is no
-/// recurring initialization overhead (unlike prev_prime()) for
-/// this reason iterator::next_prime() runs up to 2x faster
-/// than iterator::prev_prime().
-///
-void PrimeGenerator::fillNextPrimes(std::vector<uint64_t>& primes,
-                                    size_t* size)
-{
-  do
-  {
-    if (sieveIdx_ >= sieveSize_)
-      if (!sieveNextPrimes(primes, size))
-        return;
-
-    // Use local variables to prevent the compiler from
-    // writing temporary results to memory.
-    size_t i = 0;
-    size_t maxSize = primes.size();
-    assert(maxSize >= 64);
-    uint64_t low = low_;
-    uint64_t sieveIdx = sieveIdx_;
-    uint64_t sieveSize = sieveSize_;
-    uint8_t* sieve = sieve_;
-
-    // Fill the buffer with at least (maxSize - 64) primes.
-    // Each loop iteration can generate up to 64 primes
-    // so we have to stop generating primes once there is
-    // not enough space for 64 more primes.
-    do
-    {
-      uint64_t bits = littleendian_cast<uint64_t>(&sieve[sieveIdx]);
-      size_t j = i;
-      i += popcnt64(bits);
-
-      do
-      {
-        assert(j + 4 < maxSize);
-        primes[j+0] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+1] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+2] = nextPrime(bits, low); bits &= bits - 1;
-        primes[j+3] = nextPrime(bits, low); bits &= bits - 1;
-        j += 4;
-      }
-      while (j < i);
-
-      low += 8 * 30;
-      sieveIdx += 8;
-    }
-    while (i <= maxSize - 64 &&
-           sieveIdx < sieveSize);
-
-    low_ = low;
-    sieveIdx_ = sieveIdx;
-    *size = i;
-  }
-  while (*size == 0);
 }
 
 #endif
@@ -10,18 +10,23 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/config.hpp>
 #include <primesieve/forward.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/ParallelSieve.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/PrintPrimes.hpp>
 #include <primesieve/PreSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstddef>
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -49,7 +54,8 @@ const std::array<SmallPrime, 8> smallPrimes
 
 namespace primesieve {
 
-PrimeSieve::PrimeSieve()
+PrimeSieve::PrimeSieve() :
+  tuneSettings_(primesieve::getTuneSettings())
 {
   int sieveSize = get_sieve_size();
   setSieveSize(sieveSize);
@@ -59,6 +65,9 @@ PrimeSieve::PrimeSieve()
 PrimeSieve::PrimeSieve(ParallelSieve* parent) :
   flags_(parent->flags_),
   sieveSize_(parent->sieveSize_),
+  tuneSettings_(parent->tuneSettings_),
+  modulus_(parent->modulus_),
+  pattern_(parent->pattern_),
   parent_(parent)
 { }
 
@@ -67,6 +76,14 @@ PrimeSieve::~PrimeSieve() = default;
 void PrimeSieve::reset()
 {
   counts_.fill(0);
+  gapStats_.reset();
+  primeSums_.reset();
+  constellationCount_ = 0;
+
+  if (isCountPrimesMod())
+    modCounts_.assign(modulus_, 0);
+  else
+    modCounts_.clear();
   percent_ = -1.0;
   seconds_ = 0.0;
   sievedDistance_ = 0;
@@ -95,7 +112,8 @@ bool PrimeSieve::isPrintPrimes() const
 
 bool PrimeSieve::isPrint() const
 {
-  return isFlag(PRINT_PRIMES, PRINT_SEXTUPLETS);
+  return isFlag(PRINT_PRIMES, PRINT_SEXTUPLETS) ||
+         isFlag(PRINT_CONSTELLATIONS);
 }
 
 bool PrimeSieve::isCountkTuplets() const
@@ -103,6 +121,36 @@ bool PrimeSieve::isCountkTuplets() const
   return isFlag(COUNT_TWINS, COUNT_SEXTUPLETS);
 }
 
+bool PrimeSieve::isCountGaps() const
+{
+  return isFlag(COUNT_GAPS);
+}
+
+bool PrimeSieve::isCountPrimesMod() const
+{
+  return isFlag(COUNT_PRIMES_MOD);
+}
+
+/// Sum of primes, sum of squares or
+/// sum of logarithms of the primes.
+///
+bool PrimeSieve::isSumPrimes() const
+{
+  return isFlag(SUM_PRIMES, SUM_LOG_PRIMES);
+}
+
+/// Count or print user-defined prime constellations
+bool PrimeSieve::isConstellation() const
+{
+  return isFlag(COUNT_CONSTELLATIONS, PRINT_CONSTELLATIONS);
+}
+
+/// Pass the sieve array of each segment to a callback
+bool PrimeSieve::isBitmap() const
+{
+  return isFlag(SIEVE_BITMAP);
+}
+
 bool PrimeSieve::isPrintkTuplets() const
 {
   return isFlag(PRINT_TWINS, PRINT_SEXTUPLETS);
@@ -151,6 +199,51 @@ counts_t& PrimeSieve::getCounts()
   return counts_;
 }
 
+GapStats& PrimeSieve::getGapStats()
+{
+  return gapStats_;
+}
+
+uint64_t PrimeSieve::getModulus() const
+{
+  return modulus_;
+}
+
+std::vector<uint64_t>& PrimeSieve::getModCounts()
+{
+  return modCounts_;
+}
+
+PrimeSums& PrimeSieve::getPrimeSums()
+{
+  return primeSums_;
+}
+
+const std::vector<uint32_t>* PrimeSieve::getSievingPrimes() const
+{
+  return sievingPrimes_;
+}
+
+const std::vector<uint64_t>& PrimeSieve::getPattern() const
+{
+  return pattern_;
+}
+
+uint64_t PrimeSieve::getMaxFirstPrime() const
+{
+  return maxFirstPrime_;
+}
+
+uint64_t& PrimeSieve::getConstellationCount()
+{
+  return constellationCount_;
+}
+
+const BitmapCallback* PrimeSieve::getBitmapCallback() const
+{
+  return bitmapCallback_;
+}
+
 int PrimeSieve::getSieveSize() const
 {
   return sieveSize_;
@@ -166,6 +259,11 @@ PreSieve& PrimeSieve::getPreSieve()
   return preSieve_;
 }
 
+const TuneSettings& PrimeSieve::getTuneSettings() const
+{
+  return tuneSettings_;
+}
+
 void PrimeSieve::setFlags(int flags)
 {
   flags_ = flags;
@@ -176,6 +274,62 @@ void PrimeSieve::addFlags(int flags)
   flags_ |= flags;
 }
 
+/// Used for counting the primes in the
+/// residue classes modulo q (COUNT_PRIMES_MOD).
+///
+void PrimeSieve::setModulus(uint64_t q)
+{
+  if (q == 0)
+    throw primesieve_error("modulus must be > 0");
+  if (q > config::MAX_MODULUS)
+    throw primesieve_error("modulus must be <= " + std::to_string(config::MAX_MODULUS));
+
+  modulus_ = q;
+}
+
+/// Use sieving primes that have been generated once
+/// instead of generating the sieving primes anew for each
+/// sieve() call. The sieving primes must contain all
+/// primes <= sqrt(stop) (see count_primes_batch()).
+///
+void PrimeSieve::setSievingPrimes(const std::vector<uint32_t>* primes)
+{
+  sievingPrimes_ = primes;
+}
+
+/// Set the prime constellation pattern { 0, d1, d2, ... }
+/// used by COUNT_CONSTELLATIONS and PRINT_CONSTELLATIONS,
+/// e.g. { 0, 4 } cousin primes or { 0, 2, 6, 8, 12 }.
+///
+void PrimeSieve::setPattern(const std::vector<uint64_t>& pattern)
+{
+  if (pattern.empty() ||
+      pattern[0] != 0)
+    throw primesieve_error("pattern must start with 0");
+
+  for (std::size_t i = 1; i < pattern.size(); i++)
+    if (pattern[i] <= pattern[i - 1])
+      throw primesieve_error("pattern must be strictly increasing");
+
+  if (pattern.back() > config::MAX_CONSTELLATION_WIDTH)
+    throw primesieve_error("pattern width must be <= " + std::to_string(config::MAX_CONSTELLATION_WIDTH));
+
+  pattern_ = pattern;
+}
+
+void PrimeSieve::setMaxFirstPrime(uint64_t maxFirstPrime)
+{
+  maxFirstPrime_ = maxFirstPrime;
+}
+
+/// The callback is executed after each sieved segment
+/// with the segment's sieve array (SIEVE_BITMAP).
+///
+void PrimeSieve::setBitmapCallback(const BitmapCallback* callback)
+{
+  bitmapCallback_ = callback;
+}
+
 void PrimeSieve::setStart(uint64_t start)
 {
   start_ = start;
@@ -193,6 +347,15 @@ void PrimeSieve::setSieveSize(int sieveSize)
   sieveSize_ = floorPow2(sieveSize_);
 }
 
+/// Use the EratSmall/EratMedium thresholds of settings
+/// instead of the tuned settings of the current CPU,
+/// used to benchmark candidate settings in tune().
+///
+void PrimeSieve::setTuneSettings(const TuneSettings& settings)
+{
+  tuneSettings_ = settings;
+}
+
 void PrimeSieve::setStatus(double percent)
 {
   if (!parent_)
@@ -251,6 +414,52 @@ void PrimeSieve::processSmallPrimes()
         counts_[p.index]++;
       if (isPrint(p.index))
         std::cout << p.str << '\n';
+      if (isCountGaps() && p.index == 0)
+        gapStats_.addPrime(p.first);
+      if (isCountPrimesMod() && p.index == 0)
+        modCounts_[p.first % modulus_]++;
+      if (isSumPrimes() && p.index == 0)
+        primeSums_.addPrime(p.first);
+    }
+  }
+}
+
+/// Process the constellations whose first prime is 2, 3
+/// or 5, these primes are not part of the sieve array.
+///
+void PrimeSieve::processSmallConstellations()
+{
+  auto isPrime = [](uint64_t n)
+  {
+    if (n < 2)
+      return false;
+    for (uint64_t i = 2; i * i <= n; i++)
+      if (n % i == 0)
+        return false;
+    return true;
+  };
+
+  for (uint64_t p : { 2, 3, 5 })
+  {
+    if (p < start_ ||
+        p > maxFirstPrime_ ||
+        p + pattern_.back() > stop_)
+      continue;
+
+    bool isConstellation = true;
+    for (uint64_t d : pattern_)
+      isConstellation &= isPrime(p + d);
+
+    if (isConstellation)
+    {
+      if (isFlag(COUNT_CONSTELLATIONS))
+        constellationCount_++;
+      if (isFlag(PRINT_CONSTELLATIONS))
+      {
+        std::cout << '(';
+        for (std::size_t i = 0; i < pattern_.size(); i++)
+          std::cout << p + pattern_[i] << ((i + 1 < pattern_.size()) ? ", " : ")\n");
+      }
     }
   }
 }
@@ -283,6 +492,17 @@ void PrimeSieve::sieve()
 {
   reset();
 
+  if (isConstellation())
+  {
+    if (pattern_.empty())
+      throw primesieve_error("missing prime constellation pattern");
+    if ((flags_ & ~(COUNT_CONSTELLATIONS | PRINT_CONSTELLATIONS | PRINT_STATUS)) != 0)
+      throw primesieve_error("constellations cannot be combined with other count or print options");
+  }
+
+  if (isBitmap() && !bitmapCallback_)
+    throw primesieve_error("missing bitmap callback");
+
   if (start_ > stop_)
     return;
 
@@ -290,7 +510,12 @@ void PrimeSieve::sieve()
   auto t1 = std::chrono::system_clock::now();
 
   if (start_ <= 5)
-    processSmallPrimes();
+  {
+    if (isConstellation())
+      processSmallConstellations();
+    else
+      processSmallPrimes();
+  }
 
   if (stop_ >= 7)
   {
@@ -5,6 +5,13 @@
 ///         Erat) PrintPrimes is used to reconstruct primes and prime
 ///         k-tuplets from 1 bits of the sieve array.
 ///
+///         All prime k-tuplets fit into a single byte of the sieve
+///         array, hence the primes and all prime k-tuplet types are
+///         counted together in a single pass over the sieve array
+///         using bitwise operations. On x86 CPUs we dispatch at
+///         runtime to an AVX512 or AVX2 version of countTuplets()
+///         if the CPU supports it.
+///
 /// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -14,6 +21,7 @@
 #include <primesieve/PrintPrimes.hpp>
 #include <primesieve/Erat.hpp>
 #include <primesieve/forward.hpp>
+#include <primesieve/intrinsics.hpp>
 #include <primesieve/littleendian_cast.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/PrimeSieve.hpp>
@@ -21,8 +29,37 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iostream>
 #include <sstream>
+#include <vector>
+
+#if defined(__AVX512F__) && \
+    defined(__AVX512BW__) && \
+    __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX512_BW
+
+#elif defined(__AVX2__) && \
+      __has_include(<immintrin.h>)
+  #include <immintrin.h>
+  #define ENABLE_AVX2
+
+#elif (defined(ENABLE_MULTIARCH_AVX512_BW) || \
+       defined(ENABLE_MULTIARCH_AVX2)) && \
+       __has_include(<immintrin.h>)
+  #include <immintrin.h>
+
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    #include <primesieve/cpu_supports_avx512_bw.hpp>
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    #include <primesieve/cpu_supports_avx2.hpp>
+  #endif
+#endif
+
+using primesieve::counts_t;
 
 namespace {
 
@@ -36,6 +73,404 @@ const uint64_t bitmasks[6][5] =
   { 0x3f, ~0ull }                    // Prime sextuplets: b00111111
 };
 
+/// Bit i of (b & (b >> 1)) is set if the bits i and i + 1 of
+/// the sieve byte b are set, bit i of (b & (b >> 1) & (b >> 2))
+/// is set if the bits i, i + 1 and i + 2 are set, ... The masks
+/// below select the bits at which a prime k-tuplet may start
+/// (see the bitmasks above). The bits that have been shifted
+/// in from the next byte are always masked out.
+///
+const uint64_t twinsMask = 0x4a4a4a4a4a4a4a4aull;       // bits 1, 3, 6
+const uint64_t tripletsMask = 0x0f0f0f0f0f0f0f0full;    // bits 0, 1, 2, 3
+const uint64_t quadrupletsMask = 0x0202020202020202ull; // bit 1
+const uint64_t quintupletsMask = 0x0303030303030303ull; // bits 0, 1
+const uint64_t sextupletsMask = 0x0101010101010101ull;  // bit 0
+
+/// byteCounters[b] moves bit i of the sieve byte b
+/// into byte i. Used to count the 8 bits of many
+/// sieve bytes in parallel using a single addition.
+///
+std::array<uint64_t, 256> initByteCounters()
+{
+  std::array<uint64_t, 256> byteCounters;
+
+  for (uint64_t b = 0; b < 256; b++)
+  {
+    byteCounters[b] = 0;
+    for (uint64_t i = 0; i < 8; i++)
+      byteCounters[b] |= ((b >> i) & 1) << (i * 8);
+  }
+
+  return byteCounters;
+}
+
+const std::array<uint64_t, 256> byteCounters = initByteCounters();
+
+/// Number of 1 bits, sum of the bit values and sum
+/// of the squares of the bit values of each byte.
+///
+struct ByteSums
+{
+  uint64_t count;
+  uint64_t sum;
+  uint64_t squares;
+};
+
+std::array<ByteSums, 256> initByteSums()
+{
+  std::array<ByteSums, 256> byteSums;
+
+  for (uint64_t b = 0; b < 256; b++)
+  {
+    byteSums[b] = ByteSums{0, 0, 0};
+    for (uint64_t i = 0; i < 8; i++)
+    {
+      if (b & (1 << i))
+      {
+        uint64_t bitValue = primesieve::bitValues[i];
+        byteSums[b].count += 1;
+        byteSums[b].sum += bitValue;
+        byteSums[b].squares += bitValue * bitValue;
+      }
+    }
+  }
+
+  return byteSums;
+}
+
+const std::array<ByteSums, 256> byteSums = initByteSums();
+
+#if defined(PRIMESIEVE_INT128)
+
+using primesieve::uint128_t;
+
+/// Add the primes (and their squares) of the sieve bytes
+/// sieve[0, bytes[ to sums, bytes <= 4096. The primes of
+/// the sieve byte j are low + 30 * j + bitValue, hence:
+///
+/// sum(p) = low * count + 30 * sum(j * count_j) + sum(bitValues)
+///
+/// sum(p^2) is computed analogously by expanding
+/// (low + 30 * j + bitValue)^2, only low^2 * count
+/// may overflow 128 bits.
+///
+template <bool SQUARES>
+void sumBlock(const uint8_t* sieve,
+              uint64_t bytes,
+              uint64_t low,
+              primesieve::PrimeSums& sums)
+{
+  uint64_t count = 0, sum = 0, jCount = 0;
+  uint64_t squares = 0, jSum = 0, jjCount = 0;
+
+  for (uint64_t j = 0; j < bytes; j++)
+  {
+    const ByteSums& b = byteSums[sieve[j]];
+    count += b.count;
+    sum += b.sum;
+    jCount += j * b.count;
+
+    if (SQUARES)
+    {
+      squares += b.squares;
+      jSum += j * b.sum;
+      jjCount += j * j * b.count;
+    }
+  }
+
+  sums.sum += (uint128_t) low * count + jCount * 30 + sum;
+
+  if (SQUARES)
+  {
+    uint128_t rest = (uint128_t) low * (jCount * 60 + sum * 2) +
+                     jjCount * 900 + jSum * 60 + squares;
+    uint128_t low2 = (uint128_t) low * low;
+
+    if (__builtin_mul_overflow(low2, (uint128_t) count, &low2) ||
+        __builtin_add_overflow(low2, rest, &low2))
+      sums.squaresOverflow = true;
+
+    sums.addSquares(low2);
+  }
+}
+
+#endif
+
+/// Iterates over sieving primes that have been generated
+/// once and are shared by many sieve() calls. Returns
+/// the same sentinel as SievingPrimes once all sieving
+/// primes have been used up.
+///
+class SharedSievingPrimes
+{
+public:
+  SharedSievingPrimes(const std::vector<uint32_t>& primes, uint64_t maxPreSieve) :
+    it_(std::upper_bound(primes.begin(), primes.end(), maxPreSieve)),
+    end_(primes.end())
+  { }
+  uint64_t next()
+  {
+    if (it_ != end_)
+      return *it_++;
+    else
+      return ~0ull;
+  }
+private:
+  std::vector<uint32_t>::const_iterator it_;
+  std::vector<uint32_t>::const_iterator end_;
+};
+
+uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b)
+  {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/// Count the primes (counts[0]) and prime k-tuplets
+/// (counts[1] twins, counts[2] triplets, ...)
+/// inside sieve[0, words[. Without a POPCNT instruction
+/// popcnt64() is slow, hence we only count the types
+/// whose bit is set in flags.
+///
+void countTuplets_default(const uint64_t* sieve,
+                          uint64_t words,
+                          counts_t& counts,
+                          unsigned flags = 0x3f)
+{
+  uint64_t sum0 = 0, sum1 = 0, sum2 = 0;
+  uint64_t sum3 = 0, sum4 = 0, sum5 = 0;
+
+  for (uint64_t i = 0; i < words; i++)
+  {
+    uint64_t b = sieve[i];
+    uint64_t b2 = b & (b >> 1);
+    uint64_t b3 = b2 & (b >> 2);
+    uint64_t b4 = b3 & (b >> 3);
+    uint64_t b5 = b4 & (b >> 4);
+    uint64_t b6 = b5 & (b >> 5);
+
+    if (flags & (1 << 0)) sum0 += popcnt64(b);
+    if (flags & (1 << 1)) sum1 += popcnt64(b2 & twinsMask);
+    if (flags & (1 << 2)) sum2 += popcnt64(b3 & tripletsMask);
+    if (flags & (1 << 3)) sum3 += popcnt64(b4 & quadrupletsMask);
+    if (flags & (1 << 4)) sum4 += popcnt64(b5 & quintupletsMask);
+    if (flags & (1 << 5)) sum5 += popcnt64(b6 & sextupletsMask);
+  }
+
+  counts[0] += sum0;
+  counts[1] += sum1;
+  counts[2] += sum2;
+  counts[3] += sum3;
+  counts[4] += sum4;
+  counts[5] += sum5;
+}
+
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+/// Count the 1 bits of each byte using
+/// a nibble lookup table (vpshufb).
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+void countTuplets_avx2(const uint64_t* sieve,
+                       uint64_t words,
+                       counts_t& counts)
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+  const __m256i twins = _mm256_set1_epi8(0x0a);
+  const __m256i twinsHigh = _mm256_set1_epi8(0x04);
+  const __m256i triplets = _mm256_set1_epi64x(tripletsMask);
+  const __m256i quadruplets = _mm256_set1_epi64x(quadrupletsMask);
+  const __m256i quintuplets = _mm256_set1_epi64x(quintupletsMask);
+  const __m256i sextuplets = _mm256_set1_epi64x(sextupletsMask);
+  const __m256i zero = _mm256_setzero_si256();
+
+  __m256i sums[6];
+  for (auto& sum : sums)
+    sum = zero;
+
+  uint64_t i = 0;
+  uint64_t limit = words - words % 4;
+
+  while (i < limit)
+  {
+    // Each byte of the byte counters is incremented by
+    // at most 8 per iteration, hence it cannot
+    // overflow in 31 iterations.
+    uint64_t end = std::min(i + 31 * 4, limit);
+    __m256i cnt[6];
+    for (auto& c : cnt)
+      c = zero;
+
+    for (; i < end; i += 4)
+    {
+      __m256i b = _mm256_loadu_si256((const __m256i*) &sieve[i]);
+      __m256i b2 = _mm256_and_si256(b, _mm256_srli_epi64(b, 1));
+      __m256i b3 = _mm256_and_si256(b2, _mm256_srli_epi64(b, 2));
+      __m256i b4 = _mm256_and_si256(b3, _mm256_srli_epi64(b, 3));
+      __m256i b5 = _mm256_and_si256(b4, _mm256_srli_epi64(b, 4));
+      __m256i b6 = _mm256_and_si256(b5, _mm256_srli_epi64(b, 5));
+
+      // Move the twin bit 6 to bit 2, then all
+      // k-tuplet bits are inside the low nibble.
+      __m256i t1 = _mm256_or_si256(_mm256_and_si256(b2, twins),
+                                   _mm256_and_si256(_mm256_srli_epi64(b2, 4), twinsHigh));
+      __m256i t2 = _mm256_and_si256(b3, triplets);
+      __m256i t3 = _mm256_and_si256(b4, quadruplets);
+      __m256i t4 = _mm256_and_si256(b5, quintuplets);
+      __m256i t5 = _mm256_and_si256(b6, sextuplets);
+
+      __m256i lo = _mm256_and_si256(b, lowNibble);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi64(b, 4), lowNibble);
+      cnt[0] = _mm256_add_epi8(cnt[0], _mm256_shuffle_epi8(lookup, lo));
+      cnt[0] = _mm256_add_epi8(cnt[0], _mm256_shuffle_epi8(lookup, hi));
+      cnt[1] = _mm256_add_epi8(cnt[1], _mm256_shuffle_epi8(lookup, t1));
+      cnt[2] = _mm256_add_epi8(cnt[2], _mm256_shuffle_epi8(lookup, t2));
+      cnt[3] = _mm256_add_epi8(cnt[3], _mm256_shuffle_epi8(lookup, t3));
+      cnt[4] = _mm256_add_epi8(cnt[4], _mm256_shuffle_epi8(lookup, t4));
+      cnt[5] = _mm256_add_epi8(cnt[5], _mm256_shuffle_epi8(lookup, t5));
+    }
+
+    for (int j = 0; j < 6; j++)
+      sums[j] = _mm256_add_epi64(sums[j], _mm256_sad_epu8(cnt[j], zero));
+  }
+
+  for (int j = 0; j < 6; j++)
+  {
+    alignas(32) uint64_t tmp[4];
+    _mm256_store_si256((__m256i*) tmp, sums[j]);
+    counts[j] += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+  }
+
+  countTuplets_default(&sieve[i], words - i, counts);
+}
+
+#endif
+
+#if defined(ENABLE_AVX512_BW) || \
+    defined(ENABLE_MULTIARCH_AVX512_BW)
+
+/// Same algorithm as countTuplets_avx2()
+/// but processes 64 bytes per iteration.
+///
+#if defined(ENABLE_MULTIARCH_AVX512_BW)
+  __attribute__ ((target ("avx512f,avx512bw")))
+#endif
+void countTuplets_avx512(const uint64_t* sieve,
+                         uint64_t words,
+                         counts_t& counts)
+{
+  const __m512i lookup = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+  const __m512i lowNibble = _mm512_set1_epi8(0x0f);
+  const __m512i twins = _mm512_set1_epi8(0x0a);
+  const __m512i twinsHigh = _mm512_set1_epi8(0x04);
+  const __m512i triplets = _mm512_set1_epi64(tripletsMask);
+  const __m512i quadruplets = _mm512_set1_epi64(quadrupletsMask);
+  const __m512i quintuplets = _mm512_set1_epi64(quintupletsMask);
+  const __m512i sextuplets = _mm512_set1_epi64(sextupletsMask);
+  const __m512i zero = _mm512_setzero_si512();
+
+  __m512i sums[6];
+  for (auto& sum : sums)
+    sum = zero;
+
+  uint64_t i = 0;
+  uint64_t limit = words - words % 8;
+
+  while (i < limit)
+  {
+    // Each byte of the byte counters is incremented by
+    // at most 8 per iteration, hence it cannot
+    // overflow in 31 iterations.
+    uint64_t end = std::min(i + 31 * 8, limit);
+    __m512i cnt[6];
+    for (auto& c : cnt)
+      c = zero;
+
+    for (; i < end; i += 8)
+    {
+      __m512i b = _mm512_loadu_si512((const __m512i*) &sieve[i]);
+      __m512i b2 = _mm512_and_si512(b, _mm512_srli_epi64(b, 1));
+      __m512i b3 = _mm512_and_si512(b2, _mm512_srli_epi64(b, 2));
+      __m512i b4 = _mm512_and_si512(b3, _mm512_srli_epi64(b, 3));
+      __m512i b5 = _mm512_and_si512(b4, _mm512_srli_epi64(b, 4));
+      __m512i b6 = _mm512_and_si512(b5, _mm512_srli_epi64(b, 5));
+
+      // Move the twin bit 6 to bit 2, then all
+      // k-tuplet bits are inside the low nibble.
+      __m512i t1 = _mm512_ternarylogic_epi64(_mm512_and_si512(b2, twins),
+                                             _mm512_srli_epi64(b2, 4), twinsHigh, 0xf8);
+      __m512i t2 = _mm512_and_si512(b3, triplets);
+      __m512i t3 = _mm512_and_si512(b4, quadruplets);
+      __m512i t4 = _mm512_and_si512(b5, quintuplets);
+      __m512i t5 = _mm512_and_si512(b6, sextuplets);
+
+      __m512i lo = _mm512_and_si512(b, lowNibble);
+      __m512i hi = _mm512_and_si512(_mm512_srli_epi64(b, 4), lowNibble);
+      cnt[0] = _mm512_add_epi8(cnt[0], _mm512_shuffle_epi8(lookup, lo));
+      cnt[0] = _mm512_add_epi8(cnt[0], _mm512_shuffle_epi8(lookup, hi));
+      cnt[1] = _mm512_add_epi8(cnt[1], _mm512_shuffle_epi8(lookup, t1));
+      cnt[2] = _mm512_add_epi8(cnt[2], _mm512_shuffle_epi8(lookup, t2));
+      cnt[3] = _mm512_add_epi8(cnt[3], _mm512_shuffle_epi8(lookup, t3));
+      cnt[4] = _mm512_add_epi8(cnt[4], _mm512_shuffle_epi8(lookup, t4));
+      cnt[5] = _mm512_add_epi8(cnt[5], _mm512_shuffle_epi8(lookup, t5));
+    }
+
+    for (int j = 0; j < 6; j++)
+      sums[j] = _mm512_add_epi64(sums[j], _mm512_sad_epu8(cnt[j], zero));
+  }
+
+  for (int j = 0; j < 6; j++)
+    counts[j] += (uint64_t) _mm512_reduce_add_epi64(sums[j]);
+
+  countTuplets_default(&sieve[i], words - i, counts);
+}
+
+#endif
+
+/// Count the primes and prime k-tuplets using the
+/// widest vector instruction set supported by the CPU.
+/// The vector versions always count all types.
+///
+void countTuplets(const uint64_t* sieve,
+                  uint64_t words,
+                  counts_t& counts,
+                  unsigned flags)
+{
+#if defined(ENABLE_AVX512_BW)
+  countTuplets_avx512(sieve, words, counts);
+#elif defined(ENABLE_AVX2)
+  countTuplets_avx2(sieve, words, counts);
+#else
+  #if defined(ENABLE_MULTIARCH_AVX512_BW)
+    if (cpu_supports_avx512_bw)
+    {
+      countTuplets_avx512(sieve, words, counts);
+      return;
+    }
+  #endif
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    if (cpu_supports_avx2)
+    {
+      countTuplets_avx2(sieve, words, counts);
+      return;
+    }
+  #endif
+
+  countTuplets_default(sieve, words, counts, flags);
+#endif
+}
+
 } // namespace
 
 namespace primesieve {
@@ -49,40 +484,51 @@ PrintPrimes::PrintPrimes(PrimeSieve& ps) :
   uint64_t sieveSize = ps.getSieveSize();
   start = std::max<uint64_t>(start, 7);
 
-  Erat::init(start, stop, sieveSize, ps.getPreSieve(), memoryPool_);
+  isCountOnly_ = ps.isCountPrimes() &&
+                 !ps.isCountkTuplets() &&
+                 !ps.isCountGaps() &&
+                 !ps.isCountPrimesMod() &&
+                 !ps.isSumPrimes() &&
+                 !ps.isConstellation() &&
+                 !ps.isBitmap() &&
+                 !ps.isPrint();
 
-  if (ps_.isCountkTuplets())
-    initCounts();
+  if (ps.isConstellation())
+  {
+    uint64_t maxFirstPrime = std::min(ps.getMaxFirstPrime(), stop);
+    bool print = ps.isFlag(PRINT_CONSTELLATIONS);
+    constellations_.init(ps.getPattern(), maxFirstPrime, print);
+  }
+
+  Erat::init(start, stop, sieveSize, ps.getPreSieve(), memoryPool_, ps.getTuneSettings());
 }
 
-/// Initialize the lookup tables to count the number
-/// of twins, triplets, ... per byte
-///
-void PrintPrimes::initCounts()
+void PrintPrimes::sieve()
 {
-  for (unsigned i = 1; i < counts_.size(); i++)
-  {
-    if (!ps_.isCount(i))
-      continue;
+  const std::vector<uint32_t>* primes = ps_.getSievingPrimes();
 
-    kCounts_[i].resize(256);
+  if (primes)
+  {
+    uint64_t maxPreSieve = ps_.getPreSieve().getMaxPrime();
+    SharedSievingPrimes sievingPrimes(*primes, maxPreSieve);
+    sieve(sievingPrimes);
+  }
+  else
+  {
+    SievingPrimes sievingPrimes(this, ps_.getPreSieve(), memoryPool_);
+    sieve(sievingPrimes);
+  }
 
-    for (uint64_t j = 0; j < 256; j++)
-    {
-      uint8_t count = 0;
-      for (auto* b = bitmasks[i]; *b <= j; b++)
-      {
-        if ((j & *b) == *b)
-          count++;
-      }
-      kCounts_[i][j] = count;
-    }
+  if (ps_.isConstellation())
+  {
+    constellations_.finish();
+    ps_.getConstellationCount() += constellations_.getCount();
   }
 }
 
-void PrintPrimes::sieve()
+template <typename T>
+void PrintPrimes::sieve(T& sievingPrimes)
 {
-  SievingPrimes sievingPrimes(this, ps_.getPreSieve(), memoryPool_);
   uint64_t prime = sievingPrimes.next();
 
   while (hasNextSegment())
@@ -93,22 +539,41 @@ void PrintPrimes::sieve()
     for (; prime <= sqrtHigh; prime = sievingPrimes.next())
       addSievingPrime(prime);
 
-    sieveSegment();
-    print();
+    if (tileSize_)
+    {
+      counts_[0] += countSegment();
+      if (ps_.isStatus())
+        ps_.updateStatus(sieveSize_ * 30);
+    }
+    else
+    {
+      sieveSegment();
+      print();
+    }
   }
 }
 
 /// Executed after each sieved segment
 void PrintPrimes::print()
 {
-  if (ps_.isCountPrimes())
-    countPrimes();
   if (ps_.isCountkTuplets())
     countkTuplets();
+  else if (ps_.isCountPrimes())
+    countPrimes();
+  if (ps_.isCountGaps())
+    countGaps();
+  if (ps_.isCountPrimesMod())
+    countPrimesMod();
+  if (ps_.isSumPrimes())
+    sumPrimes();
   if (ps_.isPrintPrimes())
     printPrimes();
   if (ps_.isPrintkTuplets())
     printkTuplets();
+  if (ps_.isConstellation())
+    constellations_.addSegment(sieve_, sieveSize_, low_);
+  if (ps_.isBitmap())
+    sieveBitmap();
   if (ps_.isStatus())
     ps_.updateStatus(sieveSize_ * 30);
 }
@@ -119,28 +584,160 @@ void PrintPrimes::countPrimes()
   counts_[0] += popcount((const uint64_t*) sieve_, size);
 }
 
+/// Count the primes and prime k-tuplets
+/// in a single pass over the sieve array.
+///
 void PrintPrimes::countkTuplets()
 {
-  // i = 1 twins, i = 2 triplets, ...
-  for (unsigned i = 1; i < counts_.size(); i++)
+  // i = 0 primes, i = 1 twins, i = 2 triplets, ...
+  unsigned flags = 0;
+  for (unsigned i = 0; i < counts_.size(); i++)
+    if (ps_.isCount(i))
+      flags |= 1 << i;
+
+  counts_t counts;
+  counts.fill(0);
+  uint64_t words = ceilDiv(sieveSize_, 8);
+  countTuplets((const uint64_t*) sieve_, words, counts, flags);
+
+  for (unsigned i = 0; i < counts_.size(); i++)
+    if (flags & (1 << i))
+      counts_[i] += counts[i];
+}
+
+/// Add the gaps between the primes of the current
+/// segment to the prime gap statistics.
+///
+void PrintPrimes::countGaps()
+{
+  GapStats& gapStats = ps_.getGapStats();
+  uint64_t low = low_;
+
+  for (uint64_t i = 0; i < sieveSize_; i += 8)
+  {
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve_[i]);
+    for (; bits != 0; bits &= bits - 1)
+      gapStats.addPrime(nextPrime(bits, low));
+
+    low += 8 * 30;
+  }
+}
+
+/// Count the primes of the current segment in the residue
+/// classes modulo q. The numbers of the sieve byte j are
+/// low + 30 * j + {7, 11, 13, 17, 19, 23, 29, 31}, hence
+/// the residue class of bit i only depends on i and on
+/// r = (low + 30 * j) % q, which repeats after period
+/// sieve bytes. For each r we count the bits of all
+/// sieve bytes j, j + period, j + 2 * period, ... using
+/// 8 byte counters that are packed into a uint64_t (using
+/// the byteCounters lookup table). After at most 255
+/// additions we add the byte counters to the residue
+/// class counts.
+///
+void PrintPrimes::countPrimesMod()
+{
+  auto& modCounts = ps_.getModCounts();
+  uint64_t q = modCounts.size();
+  uint64_t step = 30 % q;
+  uint64_t r = low_ % q;
+  uint64_t period = q / gcd(q, 30);
+  uint64_t blockSize = period * 255;
+
+  for (uint64_t i = 0; i < sieveSize_; i += blockSize)
+  {
+    uint64_t end = std::min(i + blockSize, sieveSize_);
+    uint64_t steps = std::min(end - i, period);
+    uint64_t nextBlock = (end - i) % period;
+    uint64_t nextR = r;
+
+    for (uint64_t j = 0; j < steps; j++)
+    {
+      uint64_t bytes = 0;
+      for (uint64_t k = i + j; k < end; k += period)
+        bytes += byteCounters[sieve_[k]];
+
+      for (uint64_t bit = 0; bytes != 0; bit++, bytes >>= 8)
+        modCounts[(r + bitValues[bit]) % q] += bytes & 0xff;
+
+      r += step;
+      r = (r >= q) ? r - q : r;
+      if (j + 1 == nextBlock)
+        nextR = r;
+    }
+
+    r = nextR;
+  }
+}
+
+/// Add the primes of the current segment to the sum of
+/// primes, the sum of squares and the product of primes
+/// (for the sum of logarithms).
+///
+void PrintPrimes::sumPrimes()
+{
+  PrimeSums& sums = ps_.getPrimeSums();
+
+#if defined(PRIMESIEVE_INT128)
+  if (ps_.isFlag(SUM_PRIMES) ||
+      ps_.isFlag(SUM_PRIME_SQUARES))
   {
-    if (!ps_.isCount(i))
-      continue;
+    bool squares = ps_.isFlag(SUM_PRIME_SQUARES);
+    uint64_t blockSize = 4096;
 
-    uint64_t sum = 0;
+    for (uint64_t i = 0; i < sieveSize_; i += blockSize)
+    {
+      uint64_t bytes = std::min(blockSize, sieveSize_ - i);
+      uint64_t low = low_ + i * 30;
+
+      if (squares)
+        sumBlock<true>(&sieve_[i], bytes, low, sums);
+      else
+        sumBlock<false>(&sieve_[i], bytes, low, sums);
+    }
+  }
+#endif
+
+  if (ps_.isFlag(SUM_LOG_PRIMES))
+  {
+    // Each prime < 2^64, hence we can multiply
+    // 8 primes before the double overflows.
+    double mantissa = sums.mantissa;
+    uint64_t low = low_;
+    int i = 0;
 
-    for (uint64_t j = 0; j < sieveSize_; j += 4)
+    for (uint64_t j = 0; j < sieveSize_; j += 8)
     {
-      sum += kCounts_[i][sieve_[j+0]];
-      sum += kCounts_[i][sieve_[j+1]];
-      sum += kCounts_[i][sieve_[j+2]];
-      sum += kCounts_[i][sieve_[j+3]];
+      uint64_t bits = littleendian_cast<uint64_t>(&sieve_[j]);
+      for (; bits != 0; bits &= bits - 1)
+      {
+        mantissa *= (double) nextPrime(bits, low);
+        if_unlikely(++i == 8)
+        {
+          sums.mantissa = mantissa;
+          sums.normalize();
+          mantissa = sums.mantissa;
+          i = 0;
+        }
+      }
+
+      low += 8 * 30;
     }
 
-    counts_[i] += sum;
+    sums.mantissa = mantissa;
+    sums.normalize();
   }
 }
 
+/// Pass the sieve array of the current segment to the
+/// SIEVE_BITMAP callback. The bytes after the last sieve
+/// byte up to the next multiple of 8 have been zeroed.
+///
+void PrintPrimes::sieveBitmap() const
+{
+  (*ps_.getBitmapCallback())(low_, sieve_, (std::size_t) sieveSize_);
+}
+
 /// Print primes to stdout
 void PrintPrimes::printPrimes() const
 {
@@ -34,7 +34,7 @@ void SievingPrimes::init(Erat* erat,
   uint64_t start = preSieve.getMaxPrime() + 1;
   uint64_t stop = isqrt(erat->getStop());
   uint64_t sieveSize = erat->getSieveSize();
-  Erat::init(start, stop, sieveSize, preSieve, memoryPool);
+  Erat::init(start, stop, sieveSize, preSieve, memoryPool, erat->getTuneSettings());
   low_ = segmentLow_;
   tinySieve();
 }
@@ -15,15 +15,26 @@
 #include <primesieve/malloc_vector.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cstdlib>
 #include <cstddef>
 #include <cerrno>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 using std::size_t;
 using namespace primesieve;
 
+/// The C compressed primes container is
+/// a primesieve::compressed_primes object.
+///
+struct primesieve_compressed_primes
+{
+  compressed_primes primes;
+};
+
 namespace {
 
 template <typename T>
@@ -129,6 +140,70 @@ void primesieve_free(void* primes)
   free(primes);
 }
 
+primesieve_compressed_primes* primesieve_generate_compressed_primes(uint64_t start, uint64_t stop)
+{
+  try
+  {
+    std::unique_ptr<primesieve_compressed_primes> primes(new primesieve_compressed_primes);
+    store_primes(start, stop, primes->primes);
+    return primes.release();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_generate_compressed_primes: " << e.what() << std::endl;
+    errno = EDOM;
+    return nullptr;
+  }
+}
+
+uint64_t primesieve_append_compressed_primes(primesieve_compressed_primes* primes, uint64_t start, uint64_t stop)
+{
+  try
+  {
+    store_primes(start, stop, primes->primes);
+    return primes->primes.size();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_append_compressed_primes: " << e.what() << std::endl;
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+size_t primesieve_compressed_primes_size(const primesieve_compressed_primes* primes)
+{
+  return primes->primes.size();
+}
+
+size_t primesieve_compressed_primes_bytes(const primesieve_compressed_primes* primes)
+{
+  return primes->primes.bytes();
+}
+
+size_t primesieve_decode_compressed_primes(const primesieve_compressed_primes* primes,
+                                           size_t i,
+                                           uint64_t* buffer,
+                                           size_t n)
+{
+  const compressed_primes& cp = primes->primes;
+  if (i >= cp.size())
+    return 0;
+
+  n = std::min(n, cp.size() - i);
+  auto it = cp.at(i);
+
+  for (size_t j = 0; j < n; j++, ++it)
+    buffer[j] = *it;
+
+  return n;
+}
+
+void primesieve_free_compressed_primes(primesieve_compressed_primes* primes)
+{
+  delete primes;
+}
+
 uint64_t primesieve_nth_prime(int64_t n, uint64_t start)
 {
   try
@@ -227,6 +302,39 @@ uint64_t primesieve_count_sextuplets(uint64_t start, uint64_t stop)
   }
 }
 
+uint64_t* primesieve_count_primes_mod(uint64_t start, uint64_t stop, uint64_t q)
+{
+  try
+  {
+    std::vector<uint64_t> counts = count_primes_mod(start, stop, q);
+    malloc_vector<uint64_t> array(counts.size());
+    std::copy(counts.begin(), counts.end(), array.data());
+    array.disable_free();
+    return array.data();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_count_primes_mod: " << e.what() << std::endl;
+    errno = EDOM;
+    return nullptr;
+  }
+}
+
+uint64_t primesieve_count_constellations(uint64_t start, uint64_t stop, const uint64_t* pattern, size_t size)
+{
+  try
+  {
+    std::vector<uint64_t> vect(pattern, pattern + size);
+    return count_constellations(start, stop, vect);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_count_constellations: " << e.what() << std::endl;
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
 void primesieve_print_primes(uint64_t start, uint64_t stop)
 {
   try
@@ -305,6 +413,56 @@ void primesieve_print_sextuplets(uint64_t start, uint64_t stop)
   }
 }
 
+void primesieve_print_constellations(uint64_t start, uint64_t stop, const uint64_t* pattern, size_t size)
+{
+  try
+  {
+    std::vector<uint64_t> vect(pattern, pattern + size);
+    print_constellations(start, stop, vect);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_print_constellations: " << e.what() << std::endl;
+    errno = EDOM;
+  }
+}
+
+void primesieve_sieve_bitmap(uint64_t start, uint64_t stop, primesieve_bitmap_callback callback, void* data)
+{
+  try
+  {
+    auto bitmap = [&](uint64_t low, const uint8_t* bits, size_t bytes)
+    {
+      callback(low, bits, bytes, data);
+    };
+
+    sieve_bitmap(start, stop, bitmap);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_sieve_bitmap: " << e.what() << std::endl;
+    errno = EDOM;
+  }
+}
+
+void primesieve_parallel_sieve_bitmap(uint64_t start, uint64_t stop, primesieve_bitmap_callback callback, void* data, int ordered)
+{
+  try
+  {
+    auto bitmap = [&](uint64_t low, const uint8_t* bits, size_t bytes)
+    {
+      callback(low, bits, bytes, data);
+    };
+
+    parallel_sieve_bitmap(start, stop, bitmap, ordered != 0);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_parallel_sieve_bitmap: " << e.what() << std::endl;
+    errno = EDOM;
+  }
+}
+
 int primesieve_get_sieve_size()
 {
   return get_sieve_size();
@@ -325,6 +483,19 @@ void primesieve_set_num_threads(int num_threads)
   set_num_threads(num_threads);
 }
 
+void primesieve_tune()
+{
+  try
+  {
+    tune();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "primesieve_tune: " << e.what() << std::endl;
+    errno = EDOM;
+  }
+}
+
 uint64_t primesieve_get_max_stop()
 {
   return get_max_stop();
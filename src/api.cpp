@@ -15,12 +15,18 @@
 #include <primesieve/CpuInfo.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/PrimeSieve.hpp>
+#include <primesieve/PrimeSums.hpp>
+#include <primesieve/primesieve_error.hpp>
 #include <primesieve/ParallelSieve.hpp>
+#include <primesieve/tune.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <limits>
 #include <string>
+#include <vector>
 
 using std::size_t;
 
@@ -47,6 +53,41 @@ uint64_t count_primes(uint64_t start, uint64_t stop)
   return ps.getCount(0);
 }
 
+std::vector<uint64_t> count_primes_batch(const std::vector<std::pair<uint64_t, uint64_t>>& intervals)
+{
+  ParallelSieve ps;
+  return ps.countPrimes(intervals);
+}
+
+bool store_primes_parallel(uint64_t start, uint64_t stop, ParallelStore& store)
+{
+  ParallelSieve ps;
+  ps.setStart(start);
+  ps.setStop(stop);
+  return ps.storePrimes(store);
+}
+
+bool store_n_primes_parallel(uint64_t n, uint64_t start, ParallelStore& store)
+{
+  if (n > (uint64_t) std::numeric_limits<int64_t>::max())
+    return false;
+
+  // Approximate stop number, see store_n_primes()
+  double x = std::max(10.0, (double) start);
+  double logx = std::floor(std::log(x));
+  double dist = std::min((double) n * (logx + 1), 1e19);
+
+  ParallelSieve ps;
+  ps.setStart(start);
+  ps.setStop(checkedAdd(start, (uint64_t) dist));
+  if (ps.idealNumThreads() < 2)
+    return false;
+
+  // The n-th prime > start is the exact stop number
+  uint64_t stop = ps.nthPrime((int64_t) n, start);
+  return store_primes_parallel(start + 1, stop, store);
+}
+
 uint64_t count_twins(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
@@ -82,6 +123,52 @@ uint64_t count_sextuplets(uint64_t start, uint64_t stop)
   return ps.getCount(5);
 }
 
+std::vector<uint64_t> count_primes_mod(uint64_t start, uint64_t stop, uint64_t q)
+{
+  ParallelSieve ps;
+  ps.setModulus(q);
+  ps.sieve(start, stop, COUNT_PRIMES_MOD);
+  return ps.getModCounts();
+}
+
+uint64_t count_constellations(uint64_t start, uint64_t stop, const std::vector<uint64_t>& pattern)
+{
+  ParallelSieve ps;
+  ps.setPattern(pattern);
+  ps.sieve(start, stop, COUNT_CONSTELLATIONS);
+  return ps.getConstellationCount();
+}
+
+#if defined(PRIMESIEVE_INT128)
+
+uint128_t sum_primes(uint64_t start, uint64_t stop)
+{
+  ParallelSieve ps;
+  ps.sieve(start, stop, SUM_PRIMES);
+  return ps.getPrimeSums().sum;
+}
+
+uint128_t sum_prime_squares(uint64_t start, uint64_t stop)
+{
+  ParallelSieve ps;
+  ps.sieve(start, stop, SUM_PRIME_SQUARES);
+  const PrimeSums& sums = ps.getPrimeSums();
+
+  if (sums.squaresOverflow)
+    throw primesieve_error("sum_prime_squares: result >= 2^128");
+
+  return sums.squares;
+}
+
+#endif
+
+double sum_log_primes(uint64_t start, uint64_t stop)
+{
+  ParallelSieve ps;
+  ps.sieve(start, stop, SUM_LOG_PRIMES);
+  return ps.getPrimeSums().getLogSum();
+}
+
 void print_primes(uint64_t start, uint64_t stop)
 {
   PrimeSieve ps;
@@ -118,6 +205,28 @@ void print_sextuplets(uint64_t start, uint64_t stop)
   ps.sieve(start, stop, PRINT_SEXTUPLETS);
 }
 
+void print_constellations(uint64_t start, uint64_t stop, const std::vector<uint64_t>& pattern)
+{
+  PrimeSieve ps;
+  ps.setPattern(pattern);
+  ps.sieve(start, stop, PRINT_CONSTELLATIONS);
+}
+
+void sieve_bitmap(uint64_t start, uint64_t stop, const bitmap_callback& callback)
+{
+  PrimeSieve ps;
+  ps.setBitmapCallback(&callback);
+  ps.sieve(start, stop, SIEVE_BITMAP);
+}
+
+void parallel_sieve_bitmap(uint64_t start, uint64_t stop, const bitmap_callback& callback, bool ordered)
+{
+  ParallelSieve ps;
+  ps.setStart(start);
+  ps.setStop(stop);
+  ps.sieveBitmap(callback, ordered);
+}
+
 int get_num_threads()
 {
   if (num_threads)
@@ -153,6 +262,11 @@ int get_sieve_size()
   if (sieve_size)
     return sieve_size;
 
+  // Sieve size found using primesieve::tune()
+  int tunedSieveSize = getTuneSettings().sieveSize;
+  if (tunedSieveSize)
+    return tunedSieveSize;
+
   // The CPU cache hierarchy has become very complex and
   // hence accurately detecting the private L2 cache size has
   // become very difficult. The problem is that there are now
@@ -11,10 +11,12 @@
 
 #include "cmdoptions.hpp"
 
+#include <primesieve.hpp>
 #include <primesieve/calculator.hpp>
 #include <primesieve/CpuInfo.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/primesieve_error.hpp>
+#include <primesieve/tune.hpp>
 
 #include <cstddef>
 #include <cstdlib>
@@ -35,6 +37,7 @@ namespace {
 
 enum OptionID
 {
+  OPTION_BUILD_PI_INDEX,
   OPTION_COUNT,
   OPTION_CPU_INFO,
   OPTION_HELP,
@@ -42,12 +45,16 @@ enum OptionID
   OPTION_NO_STATUS,
   OPTION_NUMBER,
   OPTION_DISTANCE,
+  OPTION_PATTERN,
+  OPTION_GAPS,
+  OPTION_PI_INDEX,
   OPTION_PRINT,
   OPTION_QUIET,
   OPTION_SIZE,
   OPTION_TEST,
   OPTION_THREADS,
   OPTION_TIME,
+  OPTION_TUNE,
   OPTION_VERSION
 };
 
@@ -63,9 +70,12 @@ enum IsParam
 /// Command-line options
 std::map<std::string, std::pair<OptionID, IsParam>> optionMap =
 {
+  { "--build-pi-index", std::make_pair(OPTION_BUILD_PI_INDEX, REQUIRED_PARAM) },
   { "-c",          std::make_pair(OPTION_COUNT, OPTIONAL_PARAM) },
   { "--count",     std::make_pair(OPTION_COUNT, OPTIONAL_PARAM) },
   { "--cpu-info",  std::make_pair(OPTION_CPU_INFO, NO_PARAM) },
+  { "-g",          std::make_pair(OPTION_GAPS, NO_PARAM) },
+  { "--gaps",      std::make_pair(OPTION_GAPS, NO_PARAM) },
   { "-h",          std::make_pair(OPTION_HELP, NO_PARAM) },
   { "--help",      std::make_pair(OPTION_HELP, NO_PARAM) },
   { "-n",          std::make_pair(OPTION_NTH_PRIME, NO_PARAM) },
@@ -75,6 +85,8 @@ std::map<std::string, std::pair<OptionID, IsParam>> optionMap =
   { "--number",    std::make_pair(OPTION_NUMBER, REQUIRED_PARAM) },
   { "-d",          std::make_pair(OPTION_DISTANCE, REQUIRED_PARAM) },
   { "--dist",      std::make_pair(OPTION_DISTANCE, REQUIRED_PARAM) },
+  { "--pattern",   std::make_pair(OPTION_PATTERN, REQUIRED_PARAM) },
+  { "--pi-index",  std::make_pair(OPTION_PI_INDEX, REQUIRED_PARAM) },
   { "-p",          std::make_pair(OPTION_PRINT, OPTIONAL_PARAM) },
   { "--print",     std::make_pair(OPTION_PRINT, OPTIONAL_PARAM) },
   { "-q",          std::make_pair(OPTION_QUIET, NO_PARAM) },
@@ -85,6 +97,7 @@ std::map<std::string, std::pair<OptionID, IsParam>> optionMap =
   { "-t",          std::make_pair(OPTION_THREADS, REQUIRED_PARAM) },
   { "--threads",   std::make_pair(OPTION_THREADS, REQUIRED_PARAM) },
   { "--time",      std::make_pair(OPTION_TIME, NO_PARAM) },
+  { "--tune",      std::make_pair(OPTION_TUNE, NO_PARAM) },
   { "-v",          std::make_pair(OPTION_VERSION, NO_PARAM) },
   { "--version",   std::make_pair(OPTION_VERSION, NO_PARAM) }
 };
@@ -303,6 +316,28 @@ void optionDistance(Option& opt,
   numbers.push_back(start + val);
 }
 
+/// Prime constellation pattern e.g. --pattern=0,4,6
+void optionPattern(Option& opt,
+                   CmdOptions& opts)
+{
+  std::string val = opt.val;
+  opts.pattern.clear();
+
+  for (size_t pos = 0; pos <= val.size();)
+  {
+    size_t end = val.find(',', pos);
+    if (end == std::string::npos)
+      end = val.size();
+
+    Option num = opt;
+    num.val = val.substr(pos, end - pos);
+    if (num.val.empty())
+      throw primesieve_error("invalid option '" + opt.opt + "=" + val + "'");
+    opts.pattern.push_back(num.getValue<uint64_t>());
+    pos = end + 1;
+  }
+}
+
 void optionCpuInfo()
 {
   const CpuInfo cpu;
@@ -368,6 +403,20 @@ void optionCpuInfo()
   std::exit(0);
 }
 
+void optionTune()
+{
+  std::cout << "Tuning primesieve, this takes about 15 seconds..." << std::endl;
+  tune();
+
+  TuneSettings settings = getTuneSettings();
+  std::cout << "Sieve size: " << settings.sieveSize << " KiB" << std::endl;
+  std::cout << "FACTOR_ERATSMALL: " << settings.factorEratSmall << std::endl;
+  std::cout << "FACTOR_ERATMEDIUM: " << settings.factorEratMedium << std::endl;
+  std::cout << "Saved to: " << getTuneFile() << std::endl;
+
+  std::exit(0);
+}
+
 } // namespace
 
 CmdOptions parseOptions(int argc, char* argv[])
@@ -385,9 +434,13 @@ CmdOptions parseOptions(int argc, char* argv[])
 
     switch (optionID)
     {
+      case OPTION_BUILD_PI_INDEX: opts.buildPiIndex = opt.val; break;
       case OPTION_COUNT:     optionCount(opt, opts); break;
       case OPTION_CPU_INFO:  optionCpuInfo(); break;
       case OPTION_DISTANCE:  optionDistance(opt, opts); break;
+      case OPTION_GAPS:      opts.flags |= COUNT_GAPS; break;
+      case OPTION_PATTERN:   optionPattern(opt, opts); break;
+      case OPTION_PI_INDEX:  opts.piIndex = opt.val; break;
       case OPTION_PRINT:     optionPrint(opt, opts); break;
       case OPTION_SIZE:      opts.sieveSize = opt.getValue<int>(); break;
       case OPTION_THREADS:   opts.threads = opt.getValue<int>(); break;
@@ -395,6 +448,7 @@ CmdOptions parseOptions(int argc, char* argv[])
       case OPTION_NTH_PRIME: opts.nthPrime = true; break;
       case OPTION_NO_STATUS: opts.status = false; break;
       case OPTION_TIME:      opts.time = true; break;
+      case OPTION_TUNE:      optionTune(); break;
       case OPTION_NUMBER:    opts.numbers.push_back(opt.getValue<uint64_t>()); break;
       case OPTION_HELP:      help(/* exitCode */ 0); break;
       case OPTION_TEST:      test(); break;
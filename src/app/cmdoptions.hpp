@@ -1,7 +1,7 @@
 ///
 /// @file  cmdoptions.hpp
 ///
-/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -12,6 +12,8 @@
 
 #include <stdint.h>
 #include <deque>
+#include <string>
+#include <vector>
 
 struct CmdOptions
 {
@@ -23,6 +25,9 @@ struct CmdOptions
   bool nthPrime = false;
   bool status = true;
   bool time = false;
+  std::string piIndex;
+  std::string buildPiIndex;
+  std::vector<uint64_t> pattern;
 };
 
 CmdOptions parseOptions(int, char**);
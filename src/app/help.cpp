@@ -23,17 +23,27 @@ void help(int exitCode)
     "(< 2^64) using the segmented sieve of Eratosthenes.\n"
     "\n"
     "Options:\n"
+    "      --build-pi-index=FILE\n"
+    "                      Build a pi(x) index file that stores the number\n"
+    "                      of primes below each multiple of 2^28 <= STOP.\n"
     "  -c, --count[=NUM+]  Count primes and/or prime k-tuplets, NUM <= 6.\n"
     "                      Count primes: -c or --count (default option),\n"
     "                      count twin primes: -c2 or --count=2,\n"
     "                      count prime triplets: -c3 or --count=3, ...\n"
     "      --cpu-info      Print CPU information (cache sizes).\n"
     "  -d, --dist=DIST     Sieve the interval [START, START + DIST].\n"
+    "  -g, --gaps          Print prime gap statistics: maximal gaps and\n"
+    "                      the count and first occurrence of each gap.\n"
     "  -h, --help          Print this help menu.\n"
     "  -n, --nth-prime     Find the nth prime.\n"
     "                      primesieve 100 -n: finds the 100th prime,\n"
     "                      primesieve 2 100 -n: finds the 2nd prime > 100.\n"
     "      --no-status     Turn off the progressing status.\n"
+    "      --pattern=D1,D2,...\n"
+    "                      Count (or print using -p) the prime constellations\n"
+    "                      (p, p+D1, p+D2, ...) e.g. --pattern=0,4,6.\n"
+    "      --pi-index=FILE Use a pi(x) index file to speed up counting the\n"
+    "                      primes (-c) and finding the nth prime (-n).\n"
     "  -p, --print[=NUM]   Print primes or prime k-tuplets, NUM <= 6.\n"
     "                      Print primes: -p or --print,\n"
     "                      print twin primes: -p2 or --print=2,\n"
@@ -47,6 +57,8 @@ void help(int exitCode)
     "  -t, --threads=NUM   Set the number of threads, NUM <= CPU cores.\n"
     "                      Default setting: use all available CPU cores.\n"
     "      --time          Print the time elapsed in seconds.\n"
+    "      --tune          Find the fastest sieve size and sieving thresholds\n"
+    "                      for your CPU and save them to ~/.primesieve_tune.\n"
     "  -v, --version       Print version and license information.";
 
   std::cout << helpMenu << std::endl;
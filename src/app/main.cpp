@@ -8,11 +8,13 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve.hpp>
 #include <primesieve/ParallelSieve.hpp>
 #include "cmdoptions.hpp"
 
 #include <stdint.h>
 #include <array>
+#include <chrono>
 #include <iostream>
 #include <exception>
 #include <iomanip>
@@ -33,6 +35,37 @@ void printSeconds(double sec)
   std::cout << "Seconds: " << std::fixed << std::setprecision(3) << sec << std::endl;
 }
 
+/// Print the maximal prime gaps and
+/// the prime gap histogram.
+///
+void printGaps(ParallelSieve& ps)
+{
+  const GapStats& gapStats = ps.getGapStats();
+  const auto& histogram = gapStats.getHistogram();
+  uint64_t gaps = 0;
+
+  for (uint64_t count : histogram)
+    gaps += count;
+
+  std::cout << "Prime gaps: " << gaps << std::endl;
+  if (gaps == 0)
+    return;
+
+  std::cout << "Largest gap: " << gapStats.getMaxGap() << std::endl;
+  std::cout << std::endl;
+  std::cout << "Maximal gaps (gap prime):" << std::endl;
+
+  for (const auto& maximalGap : gapStats.getMaximalGaps())
+    std::cout << maximalGap.gap << " " << maximalGap.prime << std::endl;
+
+  std::cout << std::endl;
+  std::cout << "Gap histogram (gap count first_occurrence):" << std::endl;
+
+  for (uint64_t gap = 0; gap < histogram.size(); gap++)
+    if (histogram[gap])
+      std::cout << gap << " " << histogram[gap] << " " << gapStats.getFirstOccurrence(gap) << std::endl;
+}
+
 /// Count & print primes and prime k-tuplets
 void sieve(CmdOptions& opt)
 {
@@ -41,6 +74,11 @@ void sieve(CmdOptions& opt)
 
   if (opt.flags)
     ps.setFlags(opt.flags);
+  if (!opt.pattern.empty())
+  {
+    ps.setPattern(opt.pattern);
+    ps.setFlags(ps.isPrint() ? PRINT_CONSTELLATIONS : COUNT_CONSTELLATIONS);
+  }
   if (opt.status)
     ps.addFlags(PRINT_STATUS);
   if (opt.sieveSize)
@@ -89,6 +127,39 @@ void sieve(CmdOptions& opt)
         std::cout << labels[i] << ps.getCount(i) << std::endl;
     }
   }
+
+  if (ps.isFlag(COUNT_CONSTELLATIONS))
+  {
+    if (opt.quiet)
+      std::cout << ps.getConstellationCount() << std::endl;
+    else
+      std::cout << "Constellations: " << ps.getConstellationCount() << std::endl;
+  }
+
+  if (ps.isCountGaps())
+    printGaps(ps);
+}
+
+/// Build the pi(x) index for the checkpoints <= stop
+void buildPiIndex(CmdOptions& opt)
+{
+  uint64_t stop = opt.numbers.back();
+  uint64_t step = 1ull << 28;
+
+  if (!opt.quiet)
+    std::cout << "Building pi(x) index, step = 2^28" << std::endl;
+
+  auto t1 = std::chrono::system_clock::now();
+  build_pi_index(opt.buildPiIndex, stop, step);
+  auto t2 = std::chrono::system_clock::now();
+  std::chrono::duration<double> seconds = t2 - t1;
+
+  if (opt.time)
+    printSeconds(seconds.count());
+
+  std::cout << "Checkpoints: " << stop / step << std::endl;
+  if (!opt.quiet)
+    std::cout << "Saved to: " << opt.buildPiIndex << std::endl;
 }
 
 void nthPrime(CmdOptions& opt)
@@ -133,7 +204,12 @@ int main(int argc, char* argv[])
   {
     CmdOptions opt = parseOptions(argc, argv);
 
-    if (opt.nthPrime)
+    if (!opt.piIndex.empty())
+      set_pi_index(opt.piIndex);
+
+    if (!opt.buildPiIndex.empty())
+      buildPiIndex(opt);
+    else if (opt.nthPrime)
       nthPrime(opt);
     else
       sieve(opt);
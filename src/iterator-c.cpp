@@ -14,6 +14,7 @@
 #include <primesieve/PrimeGenerator.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cerrno>
 #include <exception>
 #include <iostream>
@@ -185,3 +186,105 @@ void primesieve_generate_prev_primes(primesieve_iterator* it)
   it->i = it->last_idx;
   it->primes = &primes[0];
 }
+
+namespace {
+
+/// Used by primesieve_fill_primes(). Generate the next primes,
+/// if the next prime > stop the iterator is moved back to its
+/// previous position and false is returned.
+///
+bool generateNextPrimes(primesieve_iterator* it, uint64_t stop)
+{
+  // The last prime returned by the iterator, for a new
+  // iterator (or after skipto()) this is start.
+  uint64_t prime = (it->dist == 0) ? it->start : it->primes[it->i];
+  primesieve_generate_next_primes(it);
+
+  if (it->primes[0] <= stop)
+    return true;
+
+  // primes[0] has not been stored
+  auto& primes = getPrimes(it->vector);
+  primes.insert(primes.begin(), prime);
+  it->primes = &primes[0];
+  it->last_idx++;
+  it->i = 0;
+
+  return false;
+}
+
+template <typename T>
+size_t fillPrimes(primesieve_iterator* it,
+                  T* buffer,
+                  size_t capacity,
+                  uint64_t stop)
+{
+  // UINT64_MAX is reserved as error code
+  if (~stop == 0)
+    stop--;
+
+  size_t n = 0;
+
+  while (n < capacity)
+  {
+    if (it->i == it->last_idx)
+    {
+      if (!generateNextPrimes(it, stop))
+        break;
+      buffer[n++] = (T) it->primes[0];
+      continue;
+    }
+
+    const uint64_t* primes = it->primes;
+    size_t j = it->i + 1;
+    size_t end = std::min(it->last_idx, it->i + (capacity - n));
+
+    if (primes[end] <= stop)
+    {
+      for (; j <= end; j++)
+        buffer[n++] = (T) primes[j];
+      it->i = end;
+    }
+    else
+    {
+      for (; primes[j] <= stop; j++)
+        buffer[n++] = (T) primes[j];
+      it->i = j - 1;
+      break;
+    }
+  }
+
+  return n;
+}
+
+} // namespace
+
+size_t primesieve_fill_primes(primesieve_iterator* it,
+                              void* buffer,
+                              size_t capacity,
+                              uint64_t stop,
+                              int type)
+{
+  switch (type)
+  {
+    case SHORT_PRIMES:     return fillPrimes(it, (short*) buffer, capacity, stop);
+    case USHORT_PRIMES:    return fillPrimes(it, (unsigned short*) buffer, capacity, stop);
+    case INT_PRIMES:       return fillPrimes(it, (int*) buffer, capacity, stop);
+    case UINT_PRIMES:      return fillPrimes(it, (unsigned int*) buffer, capacity, stop);
+    case LONG_PRIMES:      return fillPrimes(it, (long*) buffer, capacity, stop);
+    case ULONG_PRIMES:     return fillPrimes(it, (unsigned long*) buffer, capacity, stop);
+    case LONGLONG_PRIMES:  return fillPrimes(it, (long long*) buffer, capacity, stop);
+    case ULONGLONG_PRIMES: return fillPrimes(it, (unsigned long long*) buffer, capacity, stop);
+    case INT16_PRIMES:     return fillPrimes(it, (int16_t*) buffer, capacity, stop);
+    case UINT16_PRIMES:    return fillPrimes(it, (uint16_t*) buffer, capacity, stop);
+    case INT32_PRIMES:     return fillPrimes(it, (int32_t*) buffer, capacity, stop);
+    case UINT32_PRIMES:    return fillPrimes(it, (uint32_t*) buffer, capacity, stop);
+    case INT64_PRIMES:     return fillPrimes(it, (int64_t*) buffer, capacity, stop);
+    case UINT64_PRIMES:    return fillPrimes(it, (uint64_t*) buffer, capacity, stop);
+  }
+
+  std::cerr << "primesieve_fill_primes: Invalid type parameter!" << std::endl;
+  it->is_error = true;
+  errno = EDOM;
+  return 0;
+}
@@ -89,6 +89,28 @@ void iterator::generate_next_primes()
   last_idx_ = size - 1;
 }
 
+/// Used by fill_primes(). Generate the next primes, if the
+/// next prime > stop the iterator is moved back to its
+/// previous position and false is returned.
+///
+bool iterator::generate_next_primes(uint64_t stop)
+{
+  // The last prime returned by the iterator, for a new
+  // iterator (or after skipto()) this is start.
+  uint64_t prime = (dist_ == 0) ? start_ : primes_[i_];
+  generate_next_primes();
+
+  if (primes_[0] <= stop)
+    return true;
+
+  // primes_[0] has not been stored
+  primes_.insert(primes_.begin(), prime);
+  last_idx_++;
+  i_ = 0;
+
+  return false;
+}
+
 void iterator::generate_prev_primes()
 {
   // Special case if generate_next_primes() has
@@ -0,0 +1,354 @@
+///
+/// @file   tune.cpp
+/// @brief  Built-in autotuner. primesieve::tune() benchmarks
+///         different sieve sizes and EratSmall/EratMedium
+///         thresholds on the current machine and saves the
+///         fastest settings to the tune file. The tune file may
+///         contain settings for multiple CPUs (e.g. if the home
+///         directory is shared by different machines), each
+///         line contains the settings of one CPU:
+///
+///         sieveSize factorEratSmall factorEratMedium l1KiB l2KiB cpuName
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/tune.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace primesieve;
+
+namespace {
+
+/// The EratSmall and EratMedium sieving primes must
+/// fit into 23 bits, see EratSmall.cpp and EratMedium.cpp.
+const double MAX_FACTOR = 4.5;
+
+/// Settings of different CPUs are distinguished
+/// using the CPU name and the L1 & L2 cache sizes.
+///
+std::string cpuKey()
+{
+  std::ostringstream key;
+  key << (cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() >> 10 : 0) << " ";
+  key << (cpuInfo.hasL2Cache() ? cpuInfo.l2CacheBytes() >> 10 : 0) << " ";
+  key << (cpuInfo.hasCpuName() ? cpuInfo.cpuName() : "unknown");
+  return key.str();
+}
+
+bool isValid(const TuneSettings& settings)
+{
+  return settings.sieveSize >= 16 &&
+         settings.sieveSize <= 8192 &&
+         settings.sieveSize == floorPow2(settings.sieveSize) &&
+         settings.factorEratSmall > 0 &&
+         settings.factorEratSmall <= MAX_FACTOR &&
+         settings.factorEratMedium > 0 &&
+         settings.factorEratMedium <= MAX_FACTOR;
+}
+
+/// Parse a line of the tune file, returns
+/// false if the line is a comment or invalid.
+///
+bool parseLine(const std::string& line,
+               TuneSettings& settings,
+               std::string& key)
+{
+  if (line.empty() || line[0] == '#')
+    return false;
+
+  std::istringstream iss(line);
+  iss >> settings.sieveSize;
+  iss >> settings.factorEratSmall;
+  iss >> settings.factorEratMedium;
+
+  if (!iss || !isValid(settings))
+    return false;
+
+  std::getline(iss >> std::ws, key);
+  return !key.empty();
+}
+
+TuneSettings loadTuneSettings()
+{
+  TuneSettings settings;
+  std::string filename = getTuneFile();
+  if (filename.empty())
+    return settings;
+
+  std::ifstream file(filename);
+  std::string line;
+  std::string key;
+  std::string myKey = cpuKey();
+
+  while (std::getline(file, line))
+  {
+    TuneSettings s;
+    if (parseLine(line, s, key) &&
+        key == myKey)
+      settings = s;
+  }
+
+  return settings;
+}
+
+/// Replace the settings of the current CPU in the
+/// tune file and keep the settings of other CPUs.
+///
+void saveTuneSettings(const TuneSettings& settings)
+{
+  std::string filename = getTuneFile();
+  if (filename.empty())
+    throw primesieve_error("tune: PRIMESIEVE_TUNE_FILE is empty");
+
+  std::vector<std::string> lines;
+  std::string myKey = cpuKey();
+
+  {
+    std::ifstream file(filename);
+    std::string line;
+    std::string key;
+
+    while (std::getline(file, line))
+    {
+      TuneSettings s;
+      if (parseLine(line, s, key) &&
+          key != myKey)
+        lines.push_back(line);
+    }
+  }
+
+  std::ostringstream line;
+  line << settings.sieveSize << " "
+       << settings.factorEratSmall << " "
+       << settings.factorEratMedium << " "
+       << myKey;
+  lines.push_back(line.str());
+
+  // Other processes may currently read the tune
+  // file, hence we must not overwrite it in place.
+  std::string tmpFile = filename + ".tmp";
+
+  {
+    std::ofstream file(tmpFile, std::ios::trunc);
+    file << "# primesieve tune file, generated by primesieve --tune\n";
+    file << "# sieveSize factorEratSmall factorEratMedium l1KiB l2KiB cpuName\n";
+    for (const auto& l : lines)
+      file << l << "\n";
+
+    if (!file)
+      throw primesieve_error("tune: failed to write " + tmpFile);
+  }
+
+  if (std::rename(tmpFile.c_str(), filename.c_str()) != 0)
+  {
+    std::remove(filename.c_str());
+    if (std::rename(tmpFile.c_str(), filename.c_str()) != 0)
+      throw primesieve_error("tune: failed to write " + filename);
+  }
+}
+
+double now()
+{
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(t).count();
+}
+
+/// Seconds needed to count the primes inside the
+/// tuning intervals (single-threaded) using the
+/// candidate settings, best of 2 runs.
+///
+double benchmark(const TuneSettings& candidate,
+                 const TuneCandidates& candidates)
+{
+  double seconds = 0;
+
+  for (const auto& interval : candidates.intervals)
+  {
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < 2; i++)
+    {
+      PrimeSieve ps;
+      ps.setSieveSize(candidate.sieveSize);
+      ps.setTuneSettings(candidate);
+      double t1 = now();
+      ps.sieve(interval.first, interval.first + interval.second, COUNT_PRIMES);
+      double t2 = now();
+      best = std::min(best, t2 - t1);
+    }
+
+    seconds += best;
+  }
+
+  return seconds;
+}
+
+/// Guards the tuned settings, these may be
+/// replaced by tune() while other threads sieve.
+///
+std::mutex tuneMutex;
+
+/// Must be called with tuneMutex locked
+TuneSettings& tuneSettings()
+{
+  static TuneSettings settings = loadTuneSettings();
+  return settings;
+}
+
+} // namespace
+
+namespace primesieve {
+
+std::string getTuneFile()
+{
+  const char* file = std::getenv("PRIMESIEVE_TUNE_FILE");
+  if (file)
+    return file;
+
+#if defined(_WIN32)
+  const char* home = std::getenv("USERPROFILE");
+  const char* separator = "\\";
+#else
+  const char* home = std::getenv("HOME");
+  const char* separator = "/";
+#endif
+
+  if (!home || !*home)
+    return std::string();
+
+  return std::string(home) + separator + ".primesieve_tune";
+}
+
+TuneSettings getTuneSettings()
+{
+  std::lock_guard<std::mutex> lock(tuneMutex);
+  return tuneSettings();
+}
+
+void setTuneSettings(const TuneSettings& settings)
+{
+  std::lock_guard<std::mutex> lock(tuneMutex);
+  tuneSettings() = settings;
+}
+
+/// Intervals of small, medium and large primes that are
+/// sieved using each candidate setting. The distances
+/// have been chosen so that each interval takes roughly
+/// the same amount of time.
+///
+TuneCandidates getTuneCandidates()
+{
+  TuneCandidates candidates;
+  candidates.intervals =
+  {
+    { (uint64_t) 1e10, (uint64_t) 3e8 },
+    { (uint64_t) 1e13, (uint64_t) 2e8 },
+    { (uint64_t) 1e16, (uint64_t) 1e8 }
+  };
+
+  // Sieve sizes larger than twice the L2 cache
+  // size are never faster, don't try these.
+  int maxSieveSize = 4096;
+  if (cpuInfo.hasL2Cache())
+    maxSieveSize = (int) std::max(cpuInfo.l2CacheBytes() >> 9, (size_t) 16);
+  maxSieveSize = std::min(maxSieveSize, 8192);
+
+  for (int size = 16; size <= maxSieveSize; size *= 2)
+    candidates.sieveSizes.push_back(size);
+
+  candidates.factorsEratSmall = { 0.1, 0.15, 0.2, 0.3, 0.5, 0.75 };
+  candidates.factorsEratMedium = { 1.0, 1.25, 1.5, 1.75, 2.0, 3.0, 4.0 };
+
+  return candidates;
+}
+
+/// Find the fastest settings one after the other: first
+/// the sieve size, then FACTOR_ERATSMALL and finally
+/// FACTOR_ERATMEDIUM. Each search keeps the best
+/// settings found so far.
+///
+TuneSettings tune(const TuneCandidates& candidates)
+{
+  if (candidates.intervals.empty() ||
+      candidates.sieveSizes.empty())
+    throw primesieve_error("tune: no candidates");
+
+  TuneSettings best;
+  best.sieveSize = candidates.sieveSizes[0];
+  double bestSeconds = std::numeric_limits<double>::max();
+
+  for (int size : candidates.sieveSizes)
+  {
+    TuneSettings candidate = best;
+    candidate.sieveSize = size;
+    if (!isValid(candidate))
+      throw primesieve_error("tune: invalid sieve size");
+    double seconds = benchmark(candidate, candidates);
+    if (seconds < bestSeconds)
+    {
+      bestSeconds = seconds;
+      best = candidate;
+    }
+  }
+
+  for (double factor : candidates.factorsEratSmall)
+  {
+    TuneSettings candidate = best;
+    candidate.factorEratSmall = factor;
+    if (!isValid(candidate))
+      throw primesieve_error("tune: invalid FACTOR_ERATSMALL");
+    double seconds = benchmark(candidate, candidates);
+    if (seconds < bestSeconds)
+    {
+      bestSeconds = seconds;
+      best = candidate;
+    }
+  }
+
+  for (double factor : candidates.factorsEratMedium)
+  {
+    TuneSettings candidate = best;
+    candidate.factorEratMedium = factor;
+    if (!isValid(candidate))
+      throw primesieve_error("tune: invalid FACTOR_ERATMEDIUM");
+    double seconds = benchmark(candidate, candidates);
+    if (seconds < bestSeconds)
+    {
+      bestSeconds = seconds;
+      best = candidate;
+    }
+  }
+
+  saveTuneSettings(best);
+  setTuneSettings(best);
+
+  return best;
+}
+
+void tune()
+{
+  tune(getTuneCandidates());
+}
+
+} // namespace
@@ -0,0 +1,216 @@
+///
+/// @file   cpuid.cpp
+/// @brief  CPUID for x86 and x86-64 CPUs. Used to detect at
+///         runtime whether the CPU supports AVX2 and AVX512
+///         instructions so that we can dispatch to the fastest
+///         available implementation of hot functions.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/cpuid.hpp>
+
+#include <stdint.h>
+
+#if defined(PRIMESIEVE_X86_CPUID)
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+  #include <immintrin.h>
+#endif
+
+// CPUID bits documentation:
+// https://en.wikipedia.org/wiki/CPUID
+
+// %ebx bit flags
+#define bit_AVX2     (1 << 5)
+#define bit_AVX512F  (1 << 16)
+#define bit_AVX512CD (1 << 28)
+#define bit_AVX512BW (1 << 30)
+
+// %ecx bit flags
+#define bit_AVX512VBMI  (1 << 1)
+#define bit_AVX512VBMI2 (1 << 6)
+#define bit_AVX512VPOPCNTDQ (1 << 14)
+#define bit_OSXSAVE  (1 << 27)
+#define bit_AVX      (1 << 28)
+
+// xgetbv bit flags
+#define XSTATE_SSE (1 << 1)
+#define XSTATE_YMM (1 << 2)
+#define XSTATE_ZMM (7 << 5)
+
+namespace {
+
+void run_cpuid(int eax, int ecx, int* abcd)
+{
+#if defined(_MSC_VER)
+  __cpuidex(abcd, eax, ecx);
+#else
+  int ebx = 0;
+  int edx = 0;
+
+  #if defined(__i386__) && \
+      defined(__PIC__)
+    // In case of PIC under 32-bit EBX cannot be clobbered
+    __asm__ __volatile__("movl %%ebx, %%edi;"
+                         "cpuid;"
+                         "xchgl %%ebx, %%edi;"
+                         : "+a" (eax),
+                           "=D" (ebx),
+                           "+c" (ecx),
+                           "=d" (edx));
+  #else
+    __asm__ __volatile__("cpuid"
+                         : "+a" (eax),
+                           "=b" (ebx),
+                           "+c" (ecx),
+                           "=d" (edx));
+  #endif
+
+  abcd[0] = eax;
+  abcd[1] = ebx;
+  abcd[2] = ecx;
+  abcd[3] = edx;
+#endif
+}
+
+/// Returns the state components that the
+/// operating system saves on context switches.
+///
+uint64_t get_xgetbv()
+{
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t eax;
+  uint32_t edx;
+
+  __asm__ __volatile__("xgetbv"
+                       : "=a" (eax),
+                         "=d" (edx)
+                       : "c" (0));
+
+  return eax | (uint64_t(edx) << 32);
+#endif
+}
+
+/// Check if the CPU supports AVX and if the operating
+/// system saves the YMM registers on context switches.
+///
+bool has_os_avx()
+{
+  int abcd[4];
+  run_cpuid(1, 0, abcd);
+
+  if ((abcd[2] & bit_OSXSAVE) != bit_OSXSAVE ||
+      (abcd[2] & bit_AVX) != bit_AVX)
+    return false;
+
+  uint64_t xcr0 = get_xgetbv();
+  uint64_t ymmMask = XSTATE_SSE | XSTATE_YMM;
+
+  return (xcr0 & ymmMask) == ymmMask;
+}
+
+/// Check if the operating system saves
+/// the ZMM registers on context switches.
+///
+bool has_os_avx512()
+{
+  if (!has_os_avx())
+    return false;
+
+  uint64_t xcr0 = get_xgetbv();
+  uint64_t zmmMask = XSTATE_SSE | XSTATE_YMM | XSTATE_ZMM;
+
+  return (xcr0 & zmmMask) == zmmMask;
+}
+
+/// CPUID leaf 7 (sub-leaf 0) contains
+/// the AVX2 and AVX512 feature flags.
+///
+void run_cpuid_leaf7(int* abcd)
+{
+  abcd[0] = abcd[1] = abcd[2] = abcd[3] = 0;
+  int maxLeaf[4];
+  run_cpuid(0, 0, maxLeaf);
+
+  if (maxLeaf[0] >= 7)
+    run_cpuid(7, 0, abcd);
+}
+
+} // namespace
+
+namespace primesieve {
+
+bool has_cpuid_avx2()
+{
+  if (!has_os_avx())
+    return false;
+
+  int abcd[4];
+  run_cpuid_leaf7(abcd);
+
+  return (abcd[1] & bit_AVX2) == bit_AVX2;
+}
+
+bool has_cpuid_avx512_bw()
+{
+  if (!has_os_avx512())
+    return false;
+
+  int abcd[4];
+  run_cpuid_leaf7(abcd);
+  int mask = bit_AVX512F | bit_AVX512BW;
+
+  return (abcd[1] & mask) == mask;
+}
+
+bool has_cpuid_avx512_cd()
+{
+  if (!has_os_avx512())
+    return false;
+
+  int abcd[4];
+  run_cpuid_leaf7(abcd);
+  int mask = bit_AVX512F | bit_AVX512CD;
+
+  return (abcd[1] & mask) == mask;
+}
+
+bool has_cpuid_avx512_vpopcnt()
+{
+  if (!has_os_avx512())
+    return false;
+
+  int abcd[4];
+  run_cpuid_leaf7(abcd);
+
+  return (abcd[1] & bit_AVX512F) == bit_AVX512F &&
+         (abcd[2] & bit_AVX512VPOPCNTDQ) == bit_AVX512VPOPCNTDQ;
+}
+
+/// VBMI2 (byte compress) and VBMI (byte permute) are
+/// used together, hence we check both.
+///
+bool has_cpuid_avx512_vbmi2()
+{
+  if (!has_os_avx512())
+    return false;
+
+  int abcd[4];
+  run_cpuid_leaf7(abcd);
+  int mask = bit_AVX512F | bit_AVX512BW;
+  int mask2 = bit_AVX512VBMI | bit_AVX512VBMI2;
+
+  return (abcd[1] & mask) == mask &&
+         (abcd[2] & mask2) == mask2;
+}
+
+} // namespace
+
+#endif
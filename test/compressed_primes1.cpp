@@ -0,0 +1,110 @@
+///
+/// @file   compressed_primes1.cpp
+/// @brief  Test primesieve::compressed_primes, the decoded
+///         primes are compared with generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  {
+    std::vector<uint64_t> primes1;
+    primesieve::compressed_primes primes2;
+    primesieve::generate_primes(10000000, &primes1);
+    primesieve::generate_primes(10000000, &primes2);
+
+    std::cout << "compressed_primes(10^7).size() = " << primes2.size();
+    check(primes2.size() == primes1.size());
+    std::cout << "compressed_primes(10^7).bytes() = " << primes2.bytes();
+    check(primes2.bytes() < primes1.size() * 2);
+    std::cout << "compressed_primes(10^7) iterator";
+    check(std::equal(primes1.begin(), primes1.end(), primes2.begin()) &&
+          std::distance(primes2.begin(), primes2.end()) == (std::ptrdiff_t) primes1.size());
+    std::cout << "compressed_primes(10^7).back() = " << primes2.back();
+    check(primes2.back() == primes1.back());
+
+    bool OK = true;
+    for (std::size_t i = 0; i < primes1.size(); i += 997)
+      OK &= (primes2[i] == primes1[i]);
+
+    std::cout << "compressed_primes(10^7)[i]";
+    check(OK && primes2[0] == 2 && primes2[1] == 3);
+    std::cout << "compressed_primes(10^7).at(size())";
+    check(primes2.at(primes2.size()) == primes2.end());
+  }
+
+  // Append primes, gaps >= 256 use multiple bytes
+  {
+    uint64_t start = (uint64_t) 1e18;
+    std::vector<uint64_t> primes1;
+    primesieve::compressed_primes primes2;
+
+    for (uint64_t stop : { start + (uint64_t) 1e6, start + (uint64_t) 3e6 })
+    {
+      primesieve::generate_primes(start, stop, &primes1);
+      primesieve::generate_primes(start, stop, &primes2);
+      start = stop + 1;
+    }
+
+    std::cout << "compressed_primes(10^18, 10^18 + 3*10^6).size() = " << primes2.size();
+    check(primes2.size() == primes1.size());
+    std::cout << "compressed_primes(10^18, 10^18 + 3*10^6) iterator";
+    check(std::equal(primes1.begin(), primes1.end(), primes2.begin()));
+    std::cout << "compressed_primes(10^18, 10^18 + 3*10^6)[size() - 1] = " << primes2[primes2.size() - 1];
+    check(primes2[primes2.size() - 1] == primes1.back());
+
+    primesieve::compressed_primes primes3;
+    primes3.push_back(2);
+    primes3.push_back(1000003);
+    std::cout << "compressed_primes{2, 1000003}";
+    check(primes3[0] == 2 && primes3[1] == 1000003 && *++primes3.begin() == 1000003);
+  }
+
+  {
+    primesieve::compressed_primes primes;
+    primesieve::generate_primes(100, &primes);
+
+    try
+    {
+      primes.push_back(97);
+      std::cout << "push_back(97) after 97";
+      check(false);
+    }
+    catch (const primesieve::primesieve_error& e)
+    {
+      std::cout << "push_back(97) after 97: " << e.what();
+      check(true);
+    }
+
+    std::cout << "compressed_primes(100).size() = " << primes.size();
+    check(primes.size() == 25 && primes.back() == 97);
+    primes.clear();
+    std::cout << "compressed_primes::clear()";
+    check(primes.empty() && primes.begin() == primes.end());
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
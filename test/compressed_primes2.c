@@ -0,0 +1,82 @@
+///
+/// @file   compressed_primes2.c
+/// @brief  Test the primesieve_compressed_primes C API, the
+///         decoded primes are compared with
+///         primesieve_generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  size_t i;
+  size_t j;
+  size_t n;
+  size_t size = 0;
+  uint64_t buffer[3000];
+  uint64_t* primes = (uint64_t*) primesieve_generate_primes(0, 10000000, &size, UINT64_PRIMES);
+  primesieve_compressed_primes* cp = primesieve_generate_compressed_primes(0, 1000000);
+
+  printf("primesieve_append_compressed_primes(1000001, 10000000) = %zu", size);
+  check(primesieve_append_compressed_primes(cp, 1000001, 10000000) == size);
+  printf("primesieve_compressed_primes_size() = %zu", primesieve_compressed_primes_size(cp));
+  check(primesieve_compressed_primes_size(cp) == size);
+  printf("primesieve_compressed_primes_bytes() = %zu", primesieve_compressed_primes_bytes(cp));
+  check(primesieve_compressed_primes_bytes(cp) < size * 2);
+
+  for (i = 0; i < size; i += n)
+  {
+    n = primesieve_decode_compressed_primes(cp, i, buffer, 3000);
+    for (j = 0; j < n; j++)
+      if (buffer[j] != primes[i + j])
+        break;
+    if (n == 0 || j != n)
+      break;
+  }
+
+  printf("primesieve_decode_compressed_primes()");
+  check(i == size);
+
+  n = primesieve_decode_compressed_primes(cp, size - 10, buffer, 3000);
+  printf("primesieve_decode_compressed_primes(size - 10) = %zu", n);
+  check(n == 10 && buffer[9] == primes[size - 1]);
+
+  n = primesieve_decode_compressed_primes(cp, size, buffer, 3000);
+  printf("primesieve_decode_compressed_primes(size) = %zu", n);
+  check(n == 0);
+
+  // start must be > the largest prime in the container
+  printf("primesieve_append_compressed_primes(0, 100)");
+  check(primesieve_append_compressed_primes(cp, 0, 100) == PRIMESIEVE_ERROR && errno == EDOM);
+  printf("primesieve_compressed_primes_size() = %zu", primesieve_compressed_primes_size(cp));
+  check(primesieve_compressed_primes_size(cp) == size);
+
+  primesieve_free(primes);
+  primesieve_free_compressed_primes(cp);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
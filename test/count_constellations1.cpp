@@ -0,0 +1,143 @@
+///
+/// @file   count_constellations1.cpp
+/// @brief  Test counting user-defined prime constellations
+///         using count_constellations(). The results are
+///         compared with the constellations found in the
+///         primes generated using store_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, const std::vector<uint64_t>& pattern)
+{
+  std::vector<uint64_t> primes;
+  primesieve::store_primes(start, stop, primes);
+  uint64_t count = 0;
+
+  for (uint64_t p : primes)
+  {
+    bool found = true;
+    for (uint64_t d : pattern)
+      found &= (d <= stop - p) && std::binary_search(primes.begin(), primes.end(), p + d);
+    count += found;
+  }
+
+  std::cout << "count_constellations(" << start << ", " << stop << ", {";
+  for (std::size_t i = 0; i < pattern.size(); i++)
+    std::cout << ((i > 0) ? ", " : " ") << pattern[i];
+  std::cout << " }) = " << count;
+  check(primesieve::count_constellations(start, stop, pattern) == count);
+}
+
+int main()
+{
+  std::vector<std::vector<uint64_t>> patterns =
+  {
+    { 0 },
+    { 0, 1 },
+    { 0, 2 },
+    { 0, 4 },
+    { 0, 6 },
+    { 0, 2, 4 },
+    { 0, 2, 6 },
+    { 0, 4, 6 },
+    { 0, 2, 6, 8 },
+    { 0, 2, 6, 8, 12 },
+    { 0, 4, 6, 10, 12, 16 },
+    { 0, 2, 6, 8, 12, 18, 20 },
+    { 0, 30 },
+    { 0, 210, 420 },
+    { 0, 1000 },
+    { 0, 6, 60000 },
+    { 0, 65536 }
+  };
+
+  for (const auto& pattern : patterns)
+  {
+    for (uint64_t stop = 0; stop <= 100; stop++)
+      test(0, stop, pattern);
+    for (uint64_t start = 0; start <= 20; start++)
+      test(start, 1000, pattern);
+
+    test(0, 1000000, pattern);
+    test((uint64_t) 1e9, (uint64_t) 1e9 + (uint64_t) 1e7, pattern);
+  }
+
+  test(18446744073709551615ull - (uint64_t) 1e6, 18446744073709551615ull, { 0, 2, 6, 8, 12 });
+
+  // Constellations crossing many segments
+  primesieve::set_sieve_size(16);
+
+  for (const auto& pattern : patterns)
+    test((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 3e6, pattern);
+
+  primesieve::set_sieve_size(256);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e12);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 1e6);
+  std::uniform_int_distribution<std::size_t> distp(0, patterns.size() - 1);
+
+  for (int i = 0; i < 20; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    test(start, stop, patterns[distp(gen)]);
+  }
+
+  uint64_t count = primesieve::count_constellations(0, (uint64_t) 1e9, { 0, 2 });
+  std::cout << "Twin primes <= 10^9 = " << count;
+  check(count == primesieve::count_twins(0, (uint64_t) 1e9));
+
+  count = primesieve::count_constellations(0, (uint64_t) 1e9, { 0, 4 });
+  std::cout << "Cousin primes <= 10^9 = " << count;
+  check(count == 3424680);
+
+  std::vector<std::vector<uint64_t>> invalid =
+  {
+    { },
+    { 2 },
+    { 1, 3 },
+    { 0, 4, 4 },
+    { 0, 6, 2 },
+    { 0, 65537 }
+  };
+
+  for (const auto& pattern : invalid)
+  {
+    bool error = false;
+    try {
+      primesieve::count_constellations(0, 100, pattern);
+    }
+    catch (const primesieve::primesieve_error&) {
+      error = true;
+    }
+    std::cout << "count_constellations(invalid pattern) throws";
+    check(error);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
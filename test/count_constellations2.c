@@ -0,0 +1,58 @@
+///
+/// @file   count_constellations2.c
+/// @brief  Test counting user-defined prime
+///         constellations using the C API.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  const uint64_t twins[2] = { 0, 2 };
+  const uint64_t sexy[2] = { 0, 6 };
+  const uint64_t quintuplets[5] = { 0, 2, 6, 8, 12 };
+  const uint64_t invalid[2] = { 0, 0 };
+
+  uint64_t count = primesieve_count_constellations(0, 1000000, twins, 2);
+  printf("Twin primes <= 10^6 = %" PRIu64, count);
+  check(count == primesieve_count_twins(0, 1000000));
+
+  count = primesieve_count_constellations(0, 1000000, sexy, 2);
+  printf("Sexy primes <= 10^6 = %" PRIu64, count);
+  check(count == 16386);
+
+  count = primesieve_count_constellations(0, 1000000, quintuplets, 5);
+  printf("Prime quintuplets (p, p+2, p+6, p+8, p+12) <= 10^6 = %" PRIu64, count);
+  check(count == 34);
+
+  count = primesieve_count_constellations(0, 1000, invalid, 2);
+  printf("primesieve_count_constellations(invalid pattern) = PRIMESIEVE_ERROR");
+  check(count == PRIMESIEVE_ERROR && errno == EDOM);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
@@ -0,0 +1,178 @@
+///
+/// @file   count_gaps.cpp
+/// @brief  Test the prime gap statistics (COUNT_GAPS): compare
+///         the gap histogram, first occurrences and maximal gaps
+///         with the gaps computed using primesieve::iterator.
+///         Also test stitching together the gaps of many small
+///         intervals that are merged in random order (like
+///         ParallelSieve does).
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/GapStats.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace primesieve;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Compute the gap histogram and the first occurrences
+/// of the primes inside [start, stop] using an iterator.
+///
+void gapsIterator(uint64_t start,
+                  uint64_t stop,
+                  std::vector<uint64_t>& histogram,
+                  std::vector<uint64_t>& firstOccurrence)
+{
+  // primesieve::iterator generates primes > start
+  primesieve::iterator it(std::max(start, (uint64_t) 1) - 1, stop);
+  uint64_t prime = it.next_prime();
+  uint64_t nextPrime = it.next_prime();
+
+  for (; nextPrime <= stop; prime = nextPrime, nextPrime = it.next_prime())
+  {
+    uint64_t gap = nextPrime - prime;
+    if (gap >= histogram.size())
+    {
+      histogram.resize(gap + 1, 0);
+      firstOccurrence.resize(gap + 1, 0);
+    }
+    if (histogram[gap]++ == 0)
+      firstOccurrence[gap] = prime;
+  }
+}
+
+bool equal(const GapStats& gapStats,
+           const std::vector<uint64_t>& histogram,
+           const std::vector<uint64_t>& firstOccurrence)
+{
+  uint64_t size = std::max(gapStats.getHistogram().size(), histogram.size());
+
+  for (uint64_t gap = 0; gap < size; gap++)
+  {
+    uint64_t count = (gap < histogram.size()) ? histogram[gap] : 0;
+    uint64_t first = (count) ? firstOccurrence[gap] : 0;
+    if (gapStats.getCount(gap) != count ||
+        gapStats.getFirstOccurrence(gap) != first)
+      return false;
+  }
+
+  return true;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  std::vector<uint64_t> histogram;
+  std::vector<uint64_t> firstOccurrence;
+  gapsIterator(start, stop, histogram, firstOccurrence);
+
+  ParallelSieve ps;
+  ps.sieve(start, stop, COUNT_PRIMES | COUNT_GAPS);
+  std::cout << "gaps(" << start << ", " << stop << ")";
+  check(equal(ps.getGapStats(), histogram, firstOccurrence));
+}
+
+/// Sieve [start, stop] using many small intervals that
+/// are merged in random order, then the gaps between
+/// the intervals are added in increasing order.
+///
+void testStitching(uint64_t start, uint64_t stop, uint64_t intervals)
+{
+  std::vector<uint64_t> histogram;
+  std::vector<uint64_t> firstOccurrence;
+  gapsIterator(start, stop, histogram, firstOccurrence);
+
+  std::vector<uint64_t> order(intervals);
+  for (uint64_t i = 0; i < intervals; i++)
+    order[i] = i;
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::shuffle(order.begin(), order.end(), gen);
+
+  uint64_t dist = (stop - start) / intervals + 1;
+  std::vector<GapStats> results(intervals);
+  GapStats gapStats;
+  PrimeSieve ps;
+
+  for (uint64_t i : order)
+  {
+    uint64_t low = start + dist * i;
+    uint64_t high = std::min(low + dist - 1, stop);
+    ps.sieve(low, high, COUNT_GAPS);
+    results[i] = ps.getGapStats();
+    gapStats.mergeGaps(results[i]);
+  }
+
+  for (const auto& res : results)
+    gapStats.addInterval(res.getFirstPrime(), res.getLastPrime());
+
+  std::cout << "stitched gaps(" << start << ", " << stop << ")";
+  check(equal(gapStats, histogram, firstOccurrence));
+}
+
+int main()
+{
+  for (uint64_t stop = 0; stop <= 100; stop++)
+    test(0, stop);
+
+  for (uint64_t start = 0; start <= 100; start++)
+    test(start, 1000);
+
+  test((uint64_t) 1e9, (uint64_t) 1e9 + (uint64_t) 1e7);
+  test((uint64_t) 1e15, (uint64_t) 1e15 + (uint64_t) 1e7);
+  test(18446744073709551615ull - (uint64_t) 1e6, 18446744073709551615ull - 100);
+
+  testStitching(0, 100000, 1000);
+  testStitching((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 1e7, 200);
+
+  ParallelSieve ps;
+  ps.sieve(0, (uint64_t) 1e9, COUNT_PRIMES | COUNT_GAPS);
+  const GapStats& gapStats = ps.getGapStats();
+  auto maximalGaps = gapStats.getMaximalGaps();
+
+  std::cout << "Largest gap <= 10^9 = " << gapStats.getMaxGap();
+  check(gapStats.getMaxGap() == 282);
+
+  std::cout << "First occurrence of gap 282 = " << gapStats.getFirstOccurrence(282);
+  check(gapStats.getFirstOccurrence(282) == 436273009);
+
+  // https://oeis.org/A002386
+  const std::vector<uint64_t> maximalGapPrimes =
+  {
+    2, 3, 7, 23, 89, 113, 523, 887, 1129, 1327, 9551, 15683, 19609,
+    31397, 155921, 360653, 370261, 492113, 1349533, 1357201, 2010733,
+    4652353, 17051707, 20831323, 47326693, 122164747, 189695659,
+    191912783, 387096133, 436273009
+  };
+
+  bool OK = maximalGaps.size() == maximalGapPrimes.size();
+  for (std::size_t i = 0; OK && i < maximalGaps.size(); i++)
+    OK = maximalGaps[i].prime == maximalGapPrimes[i];
+
+  std::cout << "Maximal gaps <= 10^9 = " << maximalGaps.size();
+  check(OK);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
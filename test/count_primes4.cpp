@@ -0,0 +1,67 @@
+///
+/// @file   count_primes4.cpp
+/// @brief  Count the primes using a sieve size of 8 MiB and
+///         compare with the counts of the 32 KiB sieve size.
+///         Sieve arrays that do not fit into the L2 cache are
+///         processed in tiles (fused count pipeline).
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace primesieve;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  set_sieve_size(32);
+  uint64_t count1 = count_primes(start, stop);
+  set_sieve_size(8192);
+  uint64_t count2 = count_primes(start, stop);
+
+  std::cout << "count_primes(" << start << ", " << stop << ") = " << count2;
+  check(count1 == count2);
+}
+
+int main()
+{
+  test(0, 100);
+  test(0, (uint64_t) 1e9);
+  test(7, 8192 * 30 * 3 + 6);
+  test(8192 * 30 - 1, 8192 * 30 * 4 + 7);
+  test((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 1e9);
+  test((uint64_t) 1e17, (uint64_t) 1e17 + (uint64_t) 1e9);
+  test(18446744073709551615ull - (uint64_t) 1e9, 18446744073709551615ull);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e14);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 3e8);
+
+  for (int i = 0; i < 10; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    test(start, stop);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
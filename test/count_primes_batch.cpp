@@ -0,0 +1,94 @@
+///
+/// @file   count_primes_batch.cpp
+/// @brief  Test count_primes_batch(), the results are compared
+///         with count_primes() for each interval.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+using intervals_t = std::vector<std::pair<uint64_t, uint64_t>>;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void test(const intervals_t& intervals)
+{
+  std::vector<uint64_t> counts = primesieve::count_primes_batch(intervals);
+  std::cout << "count_primes_batch(" << intervals.size() << " intervals)";
+  check(counts.size() == intervals.size());
+
+  for (std::size_t i = 0; i < intervals.size(); i++)
+  {
+    uint64_t start = intervals[i].first;
+    uint64_t stop = intervals[i].second;
+    if (counts[i] != primesieve::count_primes(start, stop))
+    {
+      std::cout << "count_primes(" << start << ", " << stop << ")";
+      check(false);
+    }
+  }
+
+  std::cout << "count_primes_batch() == count_primes()";
+  check(true);
+}
+
+int main()
+{
+  const uint64_t max = 18446744073709551615ull;
+
+  test({});
+  test({{ 10, 0 }});
+  test({{ 0, 0 }, { 0, 1 }, { 0, 2 }, { 2, 2 }, { 3, 5 }, { 0, 100 }, { 7, 6 }});
+
+  // Overlapping and duplicate intervals
+  test({{ 0, 1000000 }, { 500000, 2000000 }, { 100, 200 },
+        { 0, 1000000 }, { 1999999, 3000000 }, { 2000000, 2000000 }});
+
+  // Large intervals that are split into many chunks
+  test({{ 0, (uint64_t) 2e8 }, { (uint64_t) 1e8, (uint64_t) 3e8 }});
+
+  // Sieving primes not shared (sqrt(stop) too large)
+  test({{ max - 100000, max }});
+
+  intervals_t intervals;
+  for (uint64_t k = 1; k <= 100; k++)
+    intervals.emplace_back(k * (uint64_t) 1e9, k * (uint64_t) 1e9 + (uint64_t) 1e6);
+  test(intervals);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e12);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 1e6);
+
+  intervals.clear();
+  for (int i = 0; i < 100; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    intervals.emplace_back(start, stop);
+    // Overlapping interval
+    intervals.emplace_back(start + dist2(gen), stop + dist2(gen));
+  }
+  test(intervals);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
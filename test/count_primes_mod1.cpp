@@ -0,0 +1,108 @@
+///
+/// @file   count_primes_mod1.cpp
+/// @brief  Test counting the primes in residue classes modulo q
+///         using count_primes_mod(). The results are compared
+///         with the residues of the primes generated using
+///         store_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, uint64_t q)
+{
+  std::vector<uint64_t> primes;
+  primesieve::store_primes(start, stop, primes);
+  std::vector<uint64_t> counts(q, 0);
+
+  for (uint64_t p : primes)
+    counts[p % q]++;
+
+  std::cout << "count_primes_mod(" << start << ", " << stop << ", " << q << ")";
+  check(primesieve::count_primes_mod(start, stop, q) == counts);
+}
+
+int main()
+{
+  for (uint64_t q = 1; q <= 40; q++)
+    for (uint64_t stop = 0; stop <= 40; stop += 5)
+      test(0, stop, q);
+
+  for (uint64_t q : { 1, 2, 3, 4, 7, 10, 30, 60, 97, 210, 256, 300, 331, 1000, 65536 })
+  {
+    test(0, 100000, q);
+    test((uint64_t) 1e9, (uint64_t) 1e9 + (uint64_t) 1e7, q);
+  }
+
+  test(18446744073709551615ull - (uint64_t) 1e7, 18446744073709551615ull, 331);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e12);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 1e7);
+  std::uniform_int_distribution<uint64_t> distq(1, 1000);
+
+  for (int i = 0; i < 20; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    test(start, stop, distq(gen));
+  }
+
+  auto counts = primesieve::count_primes_mod(0, (uint64_t) 1e10, 4);
+  std::cout << "PrimePi(10^10; 4, 1) = " << counts[1];
+  check(counts[1] == 227523275);
+  std::cout << "PrimePi(10^10; 4, 3) = " << counts[3];
+  check(counts[3] == 227529235);
+
+  uint64_t sum = std::accumulate(counts.begin(), counts.end(), (uint64_t) 0);
+  std::cout << "PrimePi(10^10) = " << sum;
+  check(sum == 455052511);
+
+  bool error = false;
+  try {
+    primesieve::count_primes_mod(0, 100, 0);
+  }
+  catch (const primesieve::primesieve_error&) {
+    error = true;
+  }
+  std::cout << "count_primes_mod(0, 100, 0) throws";
+  check(error);
+
+  error = false;
+  try {
+    primesieve::count_primes_mod(0, 100, 1ull << 40);
+  }
+  catch (const primesieve::primesieve_error&) {
+    error = true;
+  }
+  std::cout << "count_primes_mod(0, 100, 2^40) throws";
+  check(error);
+
+  counts = primesieve::count_primes_mod(0, 100, 1 << 20);
+  std::cout << "count_primes_mod(0, 100, 2^20) = " << counts.size() << " residue classes";
+  check(counts.size() == (1 << 20) && counts[97] == 1);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+///
+/// @file   count_primes_mod2.c
+/// @brief  Test counting the primes in residue
+///         classes modulo q using the C API.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  uint64_t a;
+  uint64_t q = 10;
+  uint64_t* counts = primesieve_count_primes_mod(0, 1000000, q);
+
+  // Primes <= 10^6 in the residue classes mod 10
+  const uint64_t expected[10] = { 0, 19617, 1, 19665, 0, 1, 0, 19621, 0, 19593 };
+
+  for (a = 0; a < q; a++)
+  {
+    printf("PrimePi(10^6; 10, %" PRIu64 ") = %" PRIu64, a, counts[a]);
+    check(counts[a] == expected[a]);
+  }
+
+  primesieve_free(counts);
+
+  counts = primesieve_count_primes_mod(0, 1000, 0);
+  printf("primesieve_count_primes_mod(0, 1000, 0) = NULL");
+  check(counts == NULL && errno == EDOM);
+
+  errno = 0;
+  counts = primesieve_count_primes_mod(0, 1000, 1ull << 40);
+  printf("primesieve_count_primes_mod(0, 1000, 2^40) = NULL");
+  check(counts == NULL && errno == EDOM);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+///
+/// @file   count_tuplets.cpp
+/// @brief  Count the primes and all prime k-tuplet types in a
+///         single sieving pass and compare with the counts of
+///         the count_primes(), count_twins(), ... functions.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace primesieve;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  ParallelSieve ps;
+  ps.sieve(start, stop, COUNT_PRIMES | COUNT_TWINS | COUNT_TRIPLETS |
+                        COUNT_QUADRUPLETS | COUNT_QUINTUPLETS | COUNT_SEXTUPLETS);
+
+  std::cout << "count_tuplets(" << start << ", " << stop << ")";
+  check(ps.getCount(0) == count_primes(start, stop) &&
+        ps.getCount(1) == count_twins(start, stop) &&
+        ps.getCount(2) == count_triplets(start, stop) &&
+        ps.getCount(3) == count_quadruplets(start, stop) &&
+        ps.getCount(4) == count_quintuplets(start, stop) &&
+        ps.getCount(5) == count_sextuplets(start, stop));
+}
+
+int main()
+{
+  for (uint64_t stop = 0; stop <= 1000; stop += 37)
+    test(0, stop);
+
+  test(0, (uint64_t) 1e9);
+  test((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 1e9);
+
+  ParallelSieve ps;
+  ps.sieve((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 1e9, COUNT_TWINS | COUNT_SEXTUPLETS);
+  std::cout << "Twins inside [10^12, 10^12 + 10^9] = " << ps.getCount(1);
+  check(ps.getCount(1) == 1730012);
+  std::cout << "Sextuplets inside [10^12, 10^12 + 10^9] = " << ps.getCount(5);
+  check(ps.getCount(5) == 42);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e15);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 1e7);
+
+  for (int i = 0; i < 20; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    test(start, stop);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+///
+/// @file   eratbig_avx512.cpp
+/// @brief  Check that EratBig selects the AVX512 version of
+///         crossOff() if and only if PRIMESIEVE_ERATBIG_AVX512=1
+///         and the CPU supports AVX512 CD. Then compare the sieve
+///         arrays of the AVX512 and scalar versions. This test is
+///         run twice: with PRIMESIEVE_ERATBIG_AVX512=0 and =1.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/cpuid.hpp>
+#include <primesieve/EratBig.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace primesieve;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Same logic as EratBig::useAvx512()
+bool envAvx512()
+{
+  const char* env = std::getenv("PRIMESIEVE_ERATBIG_AVX512");
+  if (env && *env)
+    return std::strcmp(env, "0") != 0;
+  return config::ERATBIG_AVX512;
+}
+
+/// Same logic as EratBig::setAvx512()
+bool cpuSupportsAvx512()
+{
+#if defined(__AVX512F__) && \
+    defined(__AVX512CD__) && \
+    __has_include(<immintrin.h>)
+  return true;
+#elif defined(ENABLE_MULTIARCH_AVX512_CD) && \
+      __has_include(<immintrin.h>)
+  return has_cpuid_avx512_cd();
+#else
+  return false;
+#endif
+}
+
+/// Cross off the multiples of the EratBig sieving primes
+/// inside [start, start + segments * sieveSize * 30[
+/// and append the sieve arrays to sieves.
+///
+bool crossOff(int avx512,
+              uint64_t start,
+              uint64_t segments,
+              std::vector<uint8_t>& sieves)
+{
+  uint64_t sieveSize = config::SIEVE_BYTES;
+  uint64_t stop = start + sieveSize * 30 * segments;
+  uint64_t sqrtStop = isqrt(stop);
+  // Like Erat, EratBig only sieves primes > maxEratMedium
+  uint64_t maxEratMedium = (uint64_t) (sieveSize * config::FACTOR_ERATMEDIUM);
+
+  MemoryPool memoryPool;
+  EratBig eratBig;
+  eratBig.init(stop, sieveSize, sqrtStop, &memoryPool);
+  bool selected = eratBig.isAvx512();
+
+  // -1 = keep the code path selected by init()
+  if (avx512 >= 0)
+    eratBig.setAvx512(avx512 != 0);
+
+  primesieve::iterator it(maxEratMedium);
+  uint64_t prime = it.next_prime();
+  uint64_t segmentLow = start;
+  std::vector<uint8_t> sieve(sieveSize);
+
+  for (uint64_t i = 0; i < segments; i++)
+  {
+    // Like Erat, we only add the sieving primes
+    // whose square is <= the current segment high.
+    uint64_t segmentHigh = segmentLow + sieveSize * 30 + 6;
+    for (; prime * prime <= segmentHigh; prime = it.next_prime())
+      eratBig.addSievingPrime(prime, segmentLow);
+
+    segmentLow += sieveSize * 30;
+    std::fill(sieve.begin(), sieve.end(), (uint8_t) 0xff);
+    eratBig.crossOff(sieve.data());
+    sieves.insert(sieves.end(), sieve.begin(), sieve.end());
+  }
+
+  return selected;
+}
+
+int main()
+{
+  bool env = envAvx512();
+  bool cpu = cpuSupportsAvx512();
+  bool expected = env && cpu;
+
+  std::cout << "PRIMESIEVE_ERATBIG_AVX512: " << (env ? "1" : "0") << std::endl;
+  std::cout << "AVX512 CD supported: " << (cpu ? "yes" : "no") << std::endl;
+
+  for (uint64_t start : { (uint64_t) 1e14, (uint64_t) 1e17, (uint64_t) 1e19 })
+  {
+    // The sieve array's segmentLow must be a multiple of 30
+    start -= start % 30;
+    uint64_t segments = 4;
+    std::vector<uint8_t> sieves1;
+    std::vector<uint8_t> sieves2;
+    std::vector<uint8_t> sieves3;
+
+    bool avx512 = crossOff(-1, start, segments, sieves1);
+    std::cout << "EratBig(" << start << ") uses " << (avx512 ? "AVX512" : "scalar") << " crossOff()";
+    check(avx512 == expected);
+
+    crossOff(0, start, segments, sieves2);
+    crossOff(1, start, segments, sieves3);
+    std::cout << "AVX512 crossOff() == scalar crossOff()";
+    check(sieves1 == sieves2 && sieves2 == sieves3);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+///
+/// @file   fill_primes1.cpp
+/// @brief  Test primesieve::iterator::fill_primes(), the primes
+///         are stored in chunks into a caller-owned buffer and
+///         compared with generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+template <typename T>
+std::vector<T> fill_primes(uint64_t start, uint64_t stop, std::size_t capacity)
+{
+  std::vector<T> primes;
+  std::vector<T> buffer(capacity);
+  primesieve::iterator it(start, stop);
+  std::size_t n;
+
+  do
+  {
+    n = it.fill_primes(buffer.data(), capacity, stop);
+    primes.insert(primes.end(), buffer.begin(), buffer.begin() + n);
+  }
+  while (n == capacity);
+
+  return primes;
+}
+
+int main()
+{
+  for (std::size_t capacity : { 1, 7, 64, 1000, 100000 })
+  {
+    std::vector<uint64_t> primes;
+    primesieve::generate_primes(1000000000, 1010000000, &primes);
+    std::cout << "fill_primes(999999999, 1010000000, capacity = " << capacity << ")";
+    check(fill_primes<uint64_t>(999999999, 1010000000, capacity) == primes);
+  }
+
+  {
+    std::vector<uint32_t> primes;
+    primesieve::generate_primes(0, 1000000, &primes);
+    std::cout << "fill_primes<uint32_t>(0, 1000000, capacity = 333)";
+    check(fill_primes<uint32_t>(0, 1000000, 333) == primes);
+  }
+
+  // Resume with increasing stop numbers
+  {
+    std::vector<uint64_t> primes;
+    std::vector<uint64_t> buffer(100000);
+    primesieve::iterator it;
+
+    for (uint64_t stop = 1000; stop <= 10000000; stop *= 10)
+    {
+      std::size_t n;
+      do
+      {
+        n = it.fill_primes(buffer.data(), buffer.size(), stop);
+        primes.insert(primes.end(), buffer.begin(), buffer.begin() + n);
+      }
+      while (n == buffer.size());
+
+      std::cout << "fill_primes(stop = " << stop << ") = " << primes.size();
+      check(primes.size() == primesieve::count_primes(0, stop));
+    }
+
+    uint64_t prime = it.next_prime();
+    std::cout << "next_prime() after fill_primes() = " << prime;
+    check(prime == 10000019);
+    prime = it.prev_prime();
+    std::cout << "prev_prime() after fill_primes() = " << prime;
+    check(prime == 9999991);
+  }
+
+  // The next prime > stop must not be consumed
+  {
+    uint64_t buffer[10];
+    primesieve::iterator it(1000);
+    std::size_t n = it.fill_primes(buffer, 10, 1000);
+    std::cout << "fill_primes(1000, 1000) = " << n;
+    check(n == 0);
+    uint64_t prime = it.prev_prime();
+    std::cout << "prev_prime() = " << prime;
+    check(prime == 997);
+    prime = it.next_prime();
+    std::cout << "next_prime() = " << prime;
+    check(prime == 1009);
+  }
+
+  // Largest primes < 2^64
+  {
+    uint64_t start = 18446744073709550000ull;
+    std::vector<uint64_t> primes;
+    primesieve::generate_primes(start, primesieve::get_max_stop(), &primes);
+    std::cout << "fill_primes(2^64 - 1616, 2^64 - 1) = " << primes.size();
+    check(fill_primes<uint64_t>(start, primesieve::get_max_stop(), 10) == primes);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+///
+/// @file   fill_primes2.c
+/// @brief  Test primesieve_fill_primes(), the primes are stored
+///         in chunks into a caller-owned buffer and compared with
+///         primesieve_generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  size_t i;
+  size_t size = 0;
+  size_t total = 0;
+  size_t n;
+  uint32_t buffer[1000];
+  uint64_t prime;
+  primesieve_iterator it;
+  uint32_t* primes = (uint32_t*) primesieve_generate_primes(1000000, 2000000, &size, UINT32_PRIMES);
+
+  primesieve_init(&it);
+  primesieve_skipto(&it, 999999, 2000000);
+
+  do
+  {
+    n = primesieve_fill_primes(&it, buffer, 1000, 2000000, UINT32_PRIMES);
+    for (i = 0; i < n && total + i < size; i++)
+      if (buffer[i] != primes[total + i])
+        break;
+    if (i != n)
+      break;
+    total += n;
+  }
+  while (n == 1000);
+
+  printf("primesieve_fill_primes(999999, 2000000) = %zu", total);
+  check(total == size);
+
+  prime = primesieve_next_prime(&it);
+  printf("primesieve_next_prime() = %" PRIu64, prime);
+  check(prime == 2000003);
+
+  prime = primesieve_prev_prime(&it);
+  printf("primesieve_prev_prime() = %" PRIu64, prime);
+  check(prime == primes[size - 1]);
+
+  primesieve_free(primes);
+
+  // The next prime > stop must not be consumed
+  primesieve_skipto(&it, 1000, 2000);
+  n = primesieve_fill_primes(&it, buffer, 1000, 1000, UINT32_PRIMES);
+  printf("primesieve_fill_primes(1000, 1000) = %zu", n);
+  check(n == 0);
+
+  prime = primesieve_next_prime(&it);
+  printf("primesieve_next_prime() = %" PRIu64, prime);
+  check(prime == 1009);
+
+  n = primesieve_fill_primes(&it, buffer, 1000, 1100, -1);
+  printf("primesieve_fill_primes(invalid type) = %zu", n);
+  check(n == 0 && it.is_error && errno == EDOM);
+
+  primesieve_free_iterator(&it);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
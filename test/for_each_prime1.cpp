@@ -0,0 +1,88 @@
+///
+/// @file   for_each_prime1.cpp
+/// @brief  Test for_each_prime() and parallel_for_each_prime(),
+///         the visited primes are compared with generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+struct Sum
+{
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  void operator()(uint64_t prime)
+  {
+    count++;
+    sum += prime;
+    if (prime > max)
+      max = prime;
+  }
+};
+
+void test(uint64_t start, uint64_t stop)
+{
+  std::vector<uint64_t> primes;
+  std::vector<uint64_t> primes2;
+  primesieve::generate_primes(start, stop, &primes);
+  primesieve::for_each_prime(start, stop, [&](uint64_t prime) { primes2.push_back(prime); });
+
+  std::cout << "for_each_prime(" << start << ", " << stop << ") = " << primes2.size();
+  check(primes2 == primes);
+
+  Sum expected;
+  for (uint64_t prime : primes)
+    expected(prime);
+
+  auto reduce = [](Sum& result, const Sum& copy)
+  {
+    result.count += copy.count;
+    result.sum += copy.sum;
+    if (copy.max > result.max)
+      result.max = copy.max;
+  };
+
+  Sum res = primesieve::parallel_for_each_prime(start, stop, Sum(), reduce);
+
+  std::cout << "parallel_for_each_prime(" << start << ", " << stop << ") = " << res.count;
+  check(res.count == expected.count &&
+        res.sum == expected.sum &&
+        res.max == expected.max);
+}
+
+int main()
+{
+  uint64_t max = std::numeric_limits<uint64_t>::max();
+
+  test(0, 1000);
+  test(3, 5);
+  test(6, 6);
+  test(1000, 0);
+  test(0, (uint64_t) 1e8);
+  test((uint64_t) 1e12 + 1, (uint64_t) 1e12 + (uint64_t) 3e8);
+  test(max - (uint64_t) 1e8, max);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
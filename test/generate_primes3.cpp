@@ -0,0 +1,82 @@
+///
+/// @file   generate_primes3.cpp
+/// @brief  Test multi-threaded generate_primes() and
+///         generate_n_primes(), the results are compared
+///         with single-threaded generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = primesieve::get_num_threads();
+  std::cout << "Threads: " << threads << std::endl;
+
+  {
+    uint64_t start = (uint64_t) 1e12;
+    uint64_t stop = start + (uint64_t) 3e8;
+    std::vector<uint64_t> primes1;
+    std::vector<uint64_t> primes2 = { 7 };
+
+    primesieve::set_num_threads(1);
+    primesieve::generate_primes(start, stop, &primes1);
+    primesieve::set_num_threads(threads);
+    primesieve::generate_primes(start, stop, &primes2);
+
+    std::cout << "generate_primes(10^12, 10^12 + 3*10^8) = " << primes1.size();
+    check(primes2.size() == primes1.size() + 1 &&
+          primes2[0] == 7 &&
+          std::equal(primes1.begin(), primes1.end(), primes2.begin() + 1));
+  }
+
+  {
+    std::vector<uint32_t> primes1;
+    std::vector<uint32_t> primes2;
+
+    primesieve::set_num_threads(1);
+    primesieve::generate_primes(1000, 2000000000, &primes1);
+    primesieve::set_num_threads(threads);
+    primesieve::generate_primes(1000, 2000000000, &primes2);
+
+    std::cout << "generate_primes<uint32_t>(1000, 2*10^9) = " << primes1.size();
+    check(primes1.size() == 98222119 && primes1 == primes2);
+  }
+
+  {
+    uint64_t n = (uint64_t) 1e7;
+    uint64_t start = (uint64_t) 1e15 + 1;
+    std::vector<uint64_t> primes1;
+    std::vector<uint64_t> primes2;
+
+    primesieve::set_num_threads(1);
+    primesieve::generate_n_primes(n, start, &primes1);
+    primesieve::set_num_threads(threads);
+    primesieve::generate_n_primes(n, start, &primes2);
+
+    std::cout << "generate_n_primes(10^7, 10^15 + 1) = " << primes1.size();
+    check(primes1.size() == n && primes1 == primes2);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+///
+/// @file   next_primes1.cpp
+/// @brief  Test iterator::next_primes() and iterator::prev_primes(),
+///         the blocks of primes are compared with generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::size_t size;
+  std::vector<uint64_t> primes;
+  primesieve::generate_primes(100000000, &primes);
+
+  {
+    std::vector<uint64_t> primes2;
+    primesieve::iterator it;
+
+    while (primes2.size() < primes.size())
+    {
+      const uint64_t* block = it.next_primes(&size);
+      primes2.insert(primes2.end(), block, block + size);
+    }
+
+    primes2.resize(std::min(primes2.size(), primes.size()));
+    std::cout << "next_primes(0, 10^8) = " << primes2.size();
+    check(primes2 == primes);
+  }
+
+  {
+    // Mix next_prime() and next_primes()
+    primesieve::iterator it(1000);
+    uint64_t prime = it.next_prime();
+    const uint64_t* block = it.next_primes(&size);
+    auto pos = std::lower_bound(primes.begin(), primes.end(), 1000);
+
+    std::cout << "next_primes(" << prime << ") = " << block[0];
+    check(prime == pos[0] && size > 0 && std::equal(block, block + size, pos + 1));
+
+    // The block is invalidated by next_prime()
+    uint64_t last = block[size - 1];
+    prime = it.next_prime();
+    std::cout << "next_prime(" << last << ") = " << prime;
+    check(prime == pos[size + 1]);
+
+    prime = it.prev_prime();
+    std::cout << "prev_prime() = " << prime;
+    check(prime == pos[size]);
+  }
+
+  {
+    std::vector<uint64_t> primes2;
+    primesieve::iterator it(primes.back() + 1);
+    const uint64_t* block;
+
+    do
+    {
+      block = it.prev_primes(&size);
+      primes2.insert(primes2.begin(), block, block + size);
+    }
+    while (block[0] != 0);
+
+    std::cout << "prev_primes(10^8, 0) = " << primes2.size() - 1;
+    check(primes2[0] == 0 && std::equal(primes2.begin() + 1, primes2.end(), primes.begin()) && primes2.size() == primes.size() + 1);
+  }
+
+  {
+    // Mix prev_prime() and prev_primes()
+    primesieve::iterator it(primes.back() + 1);
+    uint64_t prime = it.prev_prime();
+    const uint64_t* block = it.prev_primes(&size);
+    std::size_t last = primes.size() - 1;
+
+    std::cout << "prev_primes(" << prime << ") = " << block[size - 1];
+    check(prime == primes[last] && size > 0 && std::equal(block, block + size, primes.begin() + last - size));
+
+    // The block is invalidated by prev_prime()
+    uint64_t first = block[0];
+    prime = it.prev_prime();
+    std::cout << "prev_prime(" << first << ") = " << prime;
+    check(prime == primes[last - size - 1]);
+
+    prime = it.next_prime();
+    std::cout << "next_prime() = " << prime;
+    check(prime == primes[last - size]);
+  }
+
+  {
+    uint64_t max_prime = 18446744073709551557ull;
+    primesieve::iterator it(max_prime - 1000);
+    const uint64_t* block;
+
+    do
+      block = it.next_primes(&size);
+    while (block[size - 1] != max_prime);
+
+    block = it.next_primes(&size);
+    std::cout << "next_primes(" << max_prime << ") = " << block[0];
+    check(size == 1 && block[0] == 18446744073709551615ull);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+///
+/// @file   next_primes2.c
+/// @brief  Test primesieve_next_primes() and
+///         primesieve_prev_primes(), the blocks of primes are
+///         compared with primesieve_generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  size_t i;
+  size_t n;
+  size_t size = 0;
+  size_t total = 0;
+  const uint64_t* block;
+  uint64_t prime;
+  primesieve_iterator it;
+  uint64_t* primes = (uint64_t*) primesieve_generate_primes(1000000, 2000000, &size, UINT64_PRIMES);
+
+  primesieve_init(&it);
+  primesieve_skipto(&it, 999999, 2000000);
+
+  while (total < size)
+  {
+    block = primesieve_next_primes(&it, &n);
+    for (i = 0; i < n && total < size; i++, total++)
+      if (block[i] != primes[total])
+        break;
+    if (i != n && total < size)
+      break;
+  }
+
+  printf("primesieve_next_primes(999999, 2000000) = %zu", total);
+  check(total == size);
+
+  prime = primesieve_next_prime(&it);
+  printf("primesieve_next_prime() = %" PRIu64, prime);
+  check(prime > primes[size - 1] && !it.is_error);
+
+  primesieve_skipto(&it, 2000000, 999999);
+  total = 0;
+
+  while (total < size)
+  {
+    block = primesieve_prev_primes(&it, &n);
+    for (i = n; i > 0 && total < size; i--, total++)
+      if (block[i - 1] != primes[size - 1 - total])
+        break;
+    if (i != 0 && total < size)
+      break;
+  }
+
+  printf("primesieve_prev_primes(2000000, 999999) = %zu", total);
+  check(total == size);
+
+  primesieve_skipto(&it, 10, 0);
+  block = primesieve_prev_primes(&it, &n);
+  printf("primesieve_prev_primes(10) = %zu", n);
+  check(n == 5 && block[0] == 0 && block[1] == 2 && block[4] == 7);
+
+  primesieve_free(primes);
+  primesieve_free_iterator(&it);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+///
+/// @file   pi_index.cpp
+/// @brief  Test building and using the pi(x) index file. The
+///         results of count_primes() and nth_prime() using the
+///         index are compared with the results without index.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  const char* filename = "primesieve_pi_index_test.bin";
+  uint64_t stop = (uint64_t) 1e9;
+  uint64_t step = 10000019;
+
+  primesieve::build_pi_index(filename, stop, step);
+  primesieve::set_pi_index(filename);
+
+  std::cout << "pi(10^9) using index = ";
+  uint64_t count = primesieve::count_primes(0, stop);
+  std::cout << count;
+  check(count == 50847534);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 12e8);
+  std::vector<std::pair<uint64_t, uint64_t>> intervals;
+  std::vector<int64_t> nth;
+
+  intervals.emplace_back(0, 0);
+  intervals.emplace_back(0, step);
+  intervals.emplace_back(step - 1, step * 2);
+  intervals.emplace_back(step * 3, step * 50);
+  intervals.emplace_back(2, stop);
+  intervals.emplace_back(step * 50 + 1, stop + (uint64_t) 1e8);
+
+  for (int i = 0; i < 20; i++)
+  {
+    uint64_t start = dist(gen);
+    intervals.emplace_back(start, start + dist(gen));
+  }
+
+  for (int64_t n : { 1, 2, 10, 1000000, 664579, 25000000, 50847534 })
+  {
+    nth.push_back(n);
+    nth.push_back(-n);
+  }
+
+  nth.push_back(50847535);
+  nth.push_back(60000000);
+
+  std::vector<uint64_t> counts;
+  std::vector<uint64_t> primes;
+
+  for (const auto& interval : intervals)
+    counts.push_back(primesieve::count_primes(interval.first, interval.second));
+
+  for (int64_t n : nth)
+    primes.push_back(primesieve::nth_prime(n, (n < 0) ? stop : 0));
+
+  // Unload the index
+  primesieve::set_pi_index("");
+
+  for (std::size_t i = 0; i < intervals.size(); i++)
+  {
+    uint64_t low = intervals[i].first;
+    uint64_t high = intervals[i].second;
+    std::cout << "count_primes(" << low << ", " << high << ") = " << counts[i];
+    check(counts[i] == primesieve::count_primes(low, high));
+  }
+
+  for (std::size_t i = 0; i < nth.size(); i++)
+  {
+    int64_t n = nth[i];
+    std::cout << "nth_prime(" << n << ", " << ((n < 0) ? stop : 0) << ") = " << primes[i];
+    check(primes[i] == primesieve::nth_prime(n, (n < 0) ? stop : 0));
+  }
+
+  {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file << "invalid index file";
+  }
+
+  try
+  {
+    std::cout << "set_pi_index(invalid file)";
+    primesieve::set_pi_index(filename);
+    check(false);
+  }
+  catch (primesieve::primesieve_error&)
+  {
+    check(true);
+  }
+
+  // Index files with a valid header but corrupted pi(x)
+  // values: pi(200) < pi(100) and pi(200) > 200 / 2 + 1.
+  for (uint64_t pi200 : { 24, 102, 46 })
+  {
+    {
+      std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+      uint64_t data[4] = { 100, 2, 25, pi200 };
+      file.write("PRIMEPI1", 8);
+      file.write((const char*) data, sizeof(data));
+    }
+
+    bool valid = true;
+
+    try
+    {
+      primesieve::set_pi_index(filename);
+    }
+    catch (primesieve::primesieve_error&)
+    {
+      valid = false;
+    }
+
+    std::cout << "set_pi_index(pi(100) = 25, pi(200) = " << pi200 << ") " << (valid ? "valid" : "invalid");
+    check(valid == (pi200 == 46));
+  }
+
+  std::cout << "count_primes(0, 299) using index = ";
+  count = primesieve::count_primes(0, 299);
+  std::cout << count;
+  check(count == 62);
+
+  primesieve::set_pi_index("");
+  std::remove(filename);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+///
+/// @file   popcount.cpp
+/// @brief  Compare popcount() (which dispatches to the fastest
+///         implementation supported by the CPU) with a simple
+///         bit counting loop using all array sizes <= 1000 and
+///         unaligned arrays.
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/forward.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+uint64_t popcount_simple(const uint64_t* array, uint64_t size)
+{
+  uint64_t cnt = 0;
+
+  for (uint64_t i = 0; i < size; i++)
+    for (uint64_t x = array[i]; x; x &= x - 1)
+      cnt++;
+
+  return cnt;
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937_64 gen(rd());
+  std::vector<uint64_t> array(1001);
+
+  for (auto& x : array)
+    x = gen();
+
+  for (uint64_t size = 0; size <= 1000; size++)
+  {
+    uint64_t cnt = primesieve::popcount(&array[1], size);
+    if (size % 50 == 0 || cnt != popcount_simple(&array[1], size))
+    {
+      std::cout << "popcount(array, " << size << ") = " << cnt;
+      check(cnt == popcount_simple(&array[1], size));
+    }
+  }
+
+  // All bits set
+  std::vector<uint64_t> ones(1000, ~0ull);
+  std::cout << "popcount(ones, 1000) = " << primesieve::popcount(ones.data(), 1000);
+  check(primesieve::popcount(ones.data(), 1000) == 64000);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+///
+/// @file   sieve_bitmap1.cpp
+/// @brief  Test sieve_bitmap() and parallel_sieve_bitmap(), the
+///         primes are decoded from the sieve arrays and compared
+///         with generate_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+struct Segment
+{
+  uint64_t low;
+  std::vector<uint8_t> bits;
+};
+
+/// Decode the primes of the segments and check that the
+/// segments are in increasing order and do not overlap.
+///
+bool decode(const std::vector<Segment>& segments,
+            std::vector<uint64_t>& primes)
+{
+  const uint64_t bitValues[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+  uint64_t next = 0;
+
+  for (const Segment& segment : segments)
+  {
+    if (segment.low % 30 != 0 ||
+        segment.low < next)
+      return false;
+
+    for (std::size_t j = 0; j < segment.bits.size(); j++)
+      for (int i = 0; i < 8; i++)
+        if (segment.bits[j] & (1 << i))
+          primes.push_back(segment.low + 30 * j + bitValues[i]);
+
+    next = segment.low + 30 * segment.bits.size();
+  }
+
+  return true;
+}
+
+int main()
+{
+  uint64_t start = (uint64_t) 1e12 + 1;
+  uint64_t stop = start + (uint64_t) 3e8;
+  std::vector<uint64_t> primes;
+  primesieve::generate_primes(start, stop, &primes);
+
+  {
+    std::vector<Segment> segments;
+    std::vector<uint64_t> primes2;
+    bool aligned = true;
+
+    primesieve::sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+    {
+      aligned &= ((uintptr_t) bits % 8 == 0);
+      segments.push_back(Segment{low, std::vector<uint8_t>(bits, bits + bytes)});
+    });
+
+    std::cout << "sieve_bitmap(10^12 + 1, 10^12 + 3*10^8 + 1) = " << segments.size() << " segments";
+    check(aligned && decode(segments, primes2) && primes2 == primes);
+  }
+
+  {
+    std::vector<uint64_t> primes1;
+    std::vector<uint64_t> primes2;
+    std::vector<Segment> segments;
+    primesieve::generate_primes(1000, &primes1);
+    primes1.erase(primes1.begin(), primes1.begin() + 3);
+
+    primesieve::sieve_bitmap(0, 1000, [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+    {
+      segments.push_back(Segment{low, std::vector<uint8_t>(bits, bits + bytes)});
+    });
+
+    std::cout << "sieve_bitmap(0, 1000) without 2, 3, 5";
+    check(decode(segments, primes2) && primes2 == primes1);
+  }
+
+  {
+    std::vector<Segment> segments;
+    std::vector<uint64_t> primes2;
+
+    primesieve::parallel_sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+    {
+      segments.push_back(Segment{low, std::vector<uint8_t>(bits, bits + bytes)});
+    });
+
+    std::cout << "parallel_sieve_bitmap(ordered) = " << segments.size() << " segments";
+    check(decode(segments, primes2) && primes2 == primes);
+  }
+
+  {
+    std::mutex mutex;
+    std::vector<Segment> segments;
+    std::vector<uint64_t> primes2;
+
+    primesieve::parallel_sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* bits, std::size_t bytes)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      segments.push_back(Segment{low, std::vector<uint8_t>(bits, bits + bytes)});
+    }, false);
+
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& a, const Segment& b) { return a.low < b.low; });
+
+    std::cout << "parallel_sieve_bitmap(unordered) = " << segments.size() << " segments";
+    check(decode(segments, primes2) && primes2 == primes);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
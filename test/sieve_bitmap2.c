@@ -0,0 +1,83 @@
+///
+/// @file   sieve_bitmap2.c
+/// @brief  Test primesieve_sieve_bitmap() and
+///         primesieve_parallel_sieve_bitmap(), the 1 bits of the
+///         sieve arrays are compared with primesieve_count_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+typedef struct
+{
+  uint64_t count;
+  uint64_t next;
+  int error;
+} Result;
+
+void count_bits(uint64_t low, const uint8_t* bits, size_t bytes, void* data)
+{
+  Result* res = (Result*) data;
+  const uint64_t* words = (const uint64_t*) bits;
+  size_t i;
+  int j;
+
+  if (low % 30 != 0 || low < res->next)
+    res->error = 1;
+
+  // The sieve array is zero padded to a multiple of 8 bytes
+  for (i = 0; i < (bytes + 7) / 8; i++)
+    for (j = 0; j < 64; j++)
+      res->count += (words[i] >> j) & 1;
+
+  res->next = low + bytes * 30;
+}
+
+int main()
+{
+  uint64_t start = 1000000000;
+  uint64_t stop = 1100000000;
+  uint64_t count = primesieve_count_primes(start, stop);
+  Result res = { 0, 0, 0 };
+
+  primesieve_sieve_bitmap(start, stop, count_bits, &res);
+  printf("primesieve_sieve_bitmap(10^9, 1.1*10^9) = %" PRIu64, res.count);
+  check(res.count == count && !res.error);
+
+  res.count = 0;
+  res.next = 0;
+  primesieve_parallel_sieve_bitmap(start, stop, count_bits, &res, 1);
+  printf("primesieve_parallel_sieve_bitmap(10^9, 1.1*10^9) = %" PRIu64, res.count);
+  check(res.count == count && !res.error);
+
+  res.count = 0;
+  res.next = 0;
+  primesieve_sieve_bitmap(0, 100, count_bits, &res);
+  printf("primesieve_sieve_bitmap(0, 100) = %" PRIu64, res.count);
+  check(res.count == 22 && !res.error);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
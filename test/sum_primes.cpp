@@ -0,0 +1,109 @@
+///
+/// @file   sum_primes.cpp
+/// @brief  Test sum_primes(), sum_prime_squares() and
+///         sum_log_primes(). The results are compared with the
+///         sums of the primes generated using store_primes().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+void test(uint64_t start, uint64_t stop)
+{
+  std::vector<uint64_t> primes;
+  primesieve::store_primes(start, stop, primes);
+  primesieve::uint128_t sum = 0;
+  primesieve::uint128_t squares = 0;
+  bool overflow = false;
+  long double logSum = 0;
+
+  for (uint64_t p : primes)
+  {
+    sum += p;
+    overflow |= __builtin_add_overflow(squares, (primesieve::uint128_t) p * p, &squares);
+    logSum += std::log((long double) p);
+  }
+
+  std::cout << "sum_primes(" << start << ", " << stop << ")";
+  check(primesieve::sum_primes(start, stop) == sum);
+
+  std::cout << "sum_prime_squares(" << start << ", " << stop << ")";
+  try
+  {
+    check(primesieve::sum_prime_squares(start, stop) == squares && !overflow);
+  }
+  catch (primesieve::primesieve_error&)
+  {
+    check(overflow);
+  }
+
+  double theta = primesieve::sum_log_primes(start, stop);
+  double error = std::abs(theta - (double) logSum);
+  std::cout << "sum_log_primes(" << start << ", " << stop << ")";
+  check(error <= 1e-9 * std::max((double) logSum, 1.0));
+}
+
+#endif
+
+int main()
+{
+#if defined(__SIZEOF_INT128__)
+  for (uint64_t stop = 0; stop <= 100; stop++)
+    test(0, stop);
+
+  test(0, 100000);
+  test(1000003, 1000003);
+  test((uint64_t) 1e9, (uint64_t) 1e9 + (uint64_t) 1e7);
+  test(18446744073709551615ull - (uint64_t) 1e4, 18446744073709551615ull);
+
+  std::cout << "sum_primes(2 * 10^6)";
+  check(primesieve::sum_primes(0, 2000000) == 142913828922ull);
+
+  std::cout << "sum_primes(10^9) = ";
+  primesieve::uint128_t sum = primesieve::sum_primes(0, (uint64_t) 1e9);
+  std::cout << (uint64_t) sum;
+  check(sum == 24739512092254535ull);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(0, (uint64_t) 1e12);
+  std::uniform_int_distribution<uint64_t> dist2(0, (uint64_t) 1e7);
+
+  for (int i = 0; i < 10; i++)
+  {
+    uint64_t start = dist(gen);
+    uint64_t stop = start + dist2(gen);
+    test(start, stop);
+  }
+#endif
+
+  double theta = primesieve::sum_log_primes(0, (uint64_t) 1e9);
+  std::cout << "theta(10^9) = " << theta;
+  check(std::abs(theta - 999968978.5776) < 1e-3);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+///
+/// @file   tune.cpp
+/// @brief  Test loading the tune file and primesieve::tune().
+///
+/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/tune.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace primesieve;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void setTuneFile(const char* filename)
+{
+#if defined(_WIN32)
+  _putenv_s("PRIMESIEVE_TUNE_FILE", filename);
+#else
+  setenv("PRIMESIEVE_TUNE_FILE", filename, 1);
+#endif
+}
+
+std::string readFile(const char* filename)
+{
+  std::ifstream file(filename);
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  return oss.str();
+}
+
+int main()
+{
+  const char* filename = "primesieve_tune_test.txt";
+  setTuneFile(filename);
+
+  {
+    std::ofstream file(filename);
+    file << "# comment\n";
+    file << "64 0.3 2 1 1 Other CPU\n";
+    file << "512 0.3 2.5 "
+         << (cpuInfo.hasL1Cache() ? cpuInfo.l1CacheBytes() >> 10 : 0) << " "
+         << (cpuInfo.hasL2Cache() ? cpuInfo.l2CacheBytes() >> 10 : 0) << " "
+         << (cpuInfo.hasCpuName() ? cpuInfo.cpuName() : "unknown") << "\n";
+  }
+
+  std::cout << "Tuned sieve size = " << get_sieve_size();
+  check(get_sieve_size() == 512);
+
+  std::cout << "Tuned FACTOR_ERATSMALL = " << getTuneSettings().factorEratSmall;
+  check(getTuneSettings().factorEratSmall == 0.3);
+
+  std::cout << "Tuned FACTOR_ERATMEDIUM = " << getTuneSettings().factorEratMedium;
+  check(getTuneSettings().factorEratMedium == 2.5);
+
+  uint64_t count = count_primes(0, (uint64_t) 1e9);
+  std::cout << "PrimePi(10^9) = " << count;
+  check(count == 50847534);
+
+  set_sieve_size(32);
+  std::cout << "User sieve size = " << get_sieve_size();
+  check(get_sieve_size() == 32);
+
+  // Same search as tune() but using small intervals and
+  // few candidates, the factors are only replaced if a
+  // candidate is faster than the default factor.
+  TuneCandidates candidates;
+  candidates.intervals = { { (uint64_t) 1e10, (uint64_t) 1e7 }, { (uint64_t) 1e14, (uint64_t) 1e7 } };
+  candidates.sieveSizes = { 32, 64 };
+  candidates.factorsEratSmall = { 0.2, 0.3 };
+  candidates.factorsEratMedium = { 1.5, 2.0 };
+
+  TuneSettings best = tune(candidates);
+  std::cout << "tune(candidates) sieve size = " << best.sieveSize;
+  check((best.sieveSize == 32 || best.sieveSize == 64) &&
+        best.sieveSize == getTuneSettings().sieveSize);
+
+  std::cout << "tune(candidates) FACTOR_ERATSMALL = " << best.factorEratSmall;
+  check((best.factorEratSmall == 0.2 || best.factorEratSmall == 0.3 || best.factorEratSmall == config::FACTOR_ERATSMALL) &&
+        best.factorEratSmall == getTuneSettings().factorEratSmall);
+
+  std::cout << "tune(candidates) FACTOR_ERATMEDIUM = " << best.factorEratMedium;
+  check((best.factorEratMedium == 1.5 || best.factorEratMedium == 2.0 || best.factorEratMedium == config::FACTOR_ERATMEDIUM) &&
+        best.factorEratMedium == getTuneSettings().factorEratMedium);
+
+  std::cout << "User sieve size = " << get_sieve_size();
+  check(get_sieve_size() == 32);
+
+  std::string content = readFile(filename);
+  std::cout << "Other CPU settings kept";
+  check(content.find("64 0.3 2 1 1 Other CPU\n") != std::string::npos);
+
+  std::cout << "Old settings replaced";
+  check(content.find("512 0.3 2.5 ") == std::string::npos);
+
+  std::ostringstream line;
+  line << best.sieveSize << " " << best.factorEratSmall << " " << best.factorEratMedium << " ";
+  std::cout << "New settings saved";
+  check(content.find("\n" + line.str()) != std::string::npos);
+
+  std::cout << "Temporary tune file renamed";
+  check(!std::ifstream(std::string(filename) + ".tmp"));
+
+  bool error = false;
+  candidates.sieveSizes = { 48 };
+  try { tune(candidates); }
+  catch (const primesieve_error&) { error = true; }
+  std::cout << "tune(candidates) with invalid sieve size";
+  check(error && readFile(filename) == content);
+
+  count = count_primes((uint64_t) 1e12, (uint64_t) 1e12 + (uint64_t) 1e9);
+  std::cout << "PrimePi(10^12 + 10^9) - PrimePi(10^12) = " << count;
+  check(count == 36190991);
+
+  std::remove(filename);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}